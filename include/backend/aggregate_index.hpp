@@ -0,0 +1,78 @@
+#ifndef AGGREGATE_INDEX_HPP
+#define AGGREGATE_INDEX_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "cell_block.hpp"
+#include "myt_lang/cell_pos.hpp"
+
+// Kahan-Babuska running sum, exact for ints below 2^53
+struct CompensatedSum {
+  double sum{0.0};
+  double compensation{0.0};
+
+  auto add(const double& value) noexcept -> void {
+    const auto total = sum + value;
+    compensation += (std::abs(sum) >= std::abs(value))
+                        ? (sum - total) + value
+                        : (value - total) + sum;
+    sum = total;
+  }
+  [[nodiscard]] auto result() const noexcept -> double {
+    return sum + compensation;
+  }
+};
+
+// Segment tree over the blocks of one column, every node keeps the totals of
+// the numeric cells under it. Saving a cell adjusts its block leaf by the
+// old and new value and refreshes the path to the root, runs of whole blocks
+// are then answered from at most two nodes per tree level instead of reading
+// the blocks.
+class AggregateIndex {
+ public:
+  // Blocks of the tallest column
+  static constexpr std::size_t LEAVES =
+      (std::size_t{std::numeric_limits<CellLimitType>::max()} + 1) /
+      CellBlock::ROWS;
+
+  struct Totals {
+    CompensatedSum sum{};
+    double product{1.0};
+    double min{std::numeric_limits<double>::infinity()};
+    double max{-std::numeric_limits<double>::infinity()};
+    std::size_t count{0};
+    bool has_floats{false};
+
+    auto merge(const Totals& other) noexcept -> void;
+  };
+
+  explicit AggregateIndex() : m_nodes() {}
+
+  // Rebuilds the leaf from all rows of `block`, `nullptr` once the block was
+  // freed
+  auto update(const std::size_t& block_idx, const CellBlock* block) noexcept
+      -> void;
+  // One cell of `block` changed from `old_number` to `new_number`, the leaf
+  // is only rebuilt when the old value was its min or max, a zero factor of
+  // its product or not finite
+  auto update_cell(const std::size_t& block_idx,
+                   const CellBlock* block,
+                   const std::optional<double>& old_number,
+                   const std::optional<double>& new_number) noexcept -> void;
+  // Totals of the inclusive block run `[first_block, last_block]`
+  [[nodiscard]] auto query(const std::size_t& first_block,
+                           const std::size_t& last_block) const noexcept
+      -> Totals;
+
+ private:
+  auto update_path(std::size_t node) noexcept -> void;
+
+  std::array<Totals, 2 * LEAVES> m_nodes;
+};
+
+#endif  // !AGGREGATE_INDEX_HPP
@@ -0,0 +1,76 @@
+#ifndef CELL_BLOCK_HPP
+#define CELL_BLOCK_HPP
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "data_cell.hpp"
+#include "myt_lang/cell_pos.hpp"
+
+// Fixed size chunk of a single column holding `ROWS` consecutive rows.
+// Cells are stored densely in `m_cells`, `m_slots` maps a row offset inside
+// the block to its index there. Numeric values are mirrored into a dense
+// typed array so range reads can scan them without touching `DataCell`s.
+class CellBlock {
+ public:
+  static constexpr std::size_t ROWS = 256;
+  using Mask = std::bitset<ROWS>;
+
+  explicit CellBlock() : m_cells(), m_slot_rows() {}
+
+  [[nodiscard]] static constexpr auto block_idx(const CellLimitType& row)
+      -> std::size_t {
+    return row / ROWS;
+  }
+  [[nodiscard]] static constexpr auto row_offset(const CellLimitType& row)
+      -> std::size_t {
+    return row % ROWS;
+  }
+
+  [[nodiscard]] auto get(const std::size_t& offset) const noexcept
+      -> const DataCell*;
+  auto set(const std::size_t& offset, const DataCell& data_cell) noexcept
+      -> void;
+  auto erase(const std::size_t& offset) noexcept -> bool;
+
+  [[nodiscard]] auto empty() const noexcept -> bool { return m_cells.empty(); }
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return m_cells.size();
+  }
+
+  [[nodiscard]] auto occupied() const noexcept -> const Mask& {
+    return m_occupied;
+  }
+  [[nodiscard]] auto numeric() const noexcept -> const Mask& {
+    return m_numeric;
+  }
+  [[nodiscard]] auto floats() const noexcept -> const Mask& { return m_floats; }
+  [[nodiscard]] auto numbers() const noexcept
+      -> const std::array<double, ROWS>& {
+    return m_numbers;
+  }
+  // `std::nullopt` unless the cell at `offset` holds an int or a float
+  [[nodiscard]] auto number(const std::size_t& offset) const noexcept
+      -> std::optional<double> {
+    if (!m_numeric.test(offset)) return std::nullopt;
+    return m_numbers[offset];
+  }
+
+ private:
+  auto update_numeric(const std::size_t& offset,
+                      const DataCell& data_cell) noexcept -> void;
+
+  Mask m_occupied{};
+  Mask m_numeric{};  // int or float value in `m_numbers`
+  Mask m_floats{};   // subset of `m_numeric` holding floats
+  std::array<double, ROWS> m_numbers{};
+  std::array<uint16_t, ROWS> m_slots{};
+  std::vector<DataCell> m_cells;
+  std::vector<uint16_t> m_slot_rows;  // index in `m_cells` -> row offset
+};
+
+#endif  // !CELL_BLOCK_HPP
@@ -4,48 +4,85 @@
 #include <optional>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "backend/myt_lang/cell_pos.hpp"
 #include "backend/myt_lang/parser.hpp"
+#include "backend/range_index.hpp"
 
 class DependenciesHandler {
  public:
-  explicit DependenciesHandler() : m_dependencies() {}
+  explicit DependenciesHandler()
+      : m_dependencies(), m_dependencies_uses(), m_range_index() {}
 
   using CellPosSet = std::unordered_set<CellPos>;
   using Dependencies = std::unordered_map<CellPos, CellPosSet>;
-  enum class VisitState { Unvisited, Visiting, Visited };
 
+  // Recalculation levels together with the dirty cells reading each seed and
+  // dirty cell, a recalculation can then skip cells whose precedents kept
+  // their value without going back to the graph
+  struct RecalcPlan {
+    std::vector<std::vector<CellPos>> levels;
+    std::unordered_map<CellPos, std::vector<CellPos>> affected;
+  };
+
+  // `offset` shifts the references of a formula shared from another cell
   auto update_dependencies(const CellPos& affected_pos,
-                           const ParsingResult& parsing_result) noexcept
-      -> void;
+                           const ParsingResult& parsing_result,
+                           const CellOffset& offset = {}) noexcept -> void;
   auto flush_dependencies() noexcept -> void;
+  // Both views expand cell ranges into single cells, meant for inspection
   [[nodiscard]] auto get_dependencies() const noexcept -> const Dependencies;
   [[nodiscard]] auto get_dependencies_uses() const noexcept
       -> const Dependencies;
   [[nodiscard]] auto get_affected_positions(const CellPos& pos) const noexcept
       -> const std::optional<CellPosSet>;
-  [[nodiscard]] auto catch_circling_cells_DFS() const noexcept
-      -> std::unordered_set<CellPos>;
+  [[nodiscard]] auto get_recalc_order(const CellPosSet& seeds) const noexcept
+      -> std::vector<CellPos>;
+  // Same order split in levels, cells of a level only read cells of earlier
+  // levels so each level can be evaluated concurrently
+  [[nodiscard]] auto get_recalc_levels(const CellPosSet& seeds) const noexcept
+      -> std::vector<std::vector<CellPos>>;
+  [[nodiscard]] auto get_recalc_plan(const CellPosSet& seeds) const noexcept
+      -> RecalcPlan;
+  // Cells on a cycle through `pos`, the graph is kept acyclic between edits
+  // so any new cycle has to go through the last edited cell
+  [[nodiscard]] auto find_cycle_through(const CellPos& pos) const noexcept
+      -> CellPosSet;
   auto filter_cyclic_dependencies(const CellPosSet& cycled) noexcept -> void;
 
+  // Calls `fn(affected_pos)` for every cell reading `pos`, a cell reading
+  // `pos` through several references is reported once per reference
+  template <typename Fn>
+  auto for_each_affected(const CellPos& pos, Fn&& fn) const noexcept -> void {
+    if (const auto it = m_dependencies.find(pos);
+        it != m_dependencies.cend()) {
+      for (const auto& affected_pos : it->second) {
+        fn(affected_pos);
+      }
+    }
+    m_range_index.for_each_owner_at(pos, fn);
+  }
+
  private:
   auto traverse_expression(const CellPos& affected_pos,
-                           const Expression& expr) noexcept -> void;
+                           const Expression& expr,
+                           const CellOffset& offset) noexcept -> void;
   auto clear_dependencies_pos(const CellPos& pos) noexcept -> void;
+  [[nodiscard]] auto collect_dirty(const CellPosSet& seeds) const noexcept
+      -> CellPosSet;
   auto append_dependency(const CellPos& value_pos,
                          const CellPos& key_pos,
                          Dependencies& deps) noexcept -> void;
+  [[nodiscard]] auto has_precedents(const CellPos& pos) const noexcept
+      -> bool;
   [[nodiscard]] static auto is_in_dependencies(
       const CellPos& key_pos,
       const Dependencies& deps) noexcept -> bool;
-  auto dfs_visit(const CellPos& node,
-                 std::unordered_map<CellPos, VisitState>& visit_states,
-                 std::unordered_set<CellPos>& cycled,
-                 std::vector<CellPos>& path_stack) const noexcept -> void;
 
   Dependencies m_dependencies;       // {1, 1}: '=B3*3' => B3: {A1} AFFECTS
   Dependencies m_dependencies_uses;  // {1, 1}: '=B3*3' => A1: {B3} USES
+  RangeIndex m_range_index;          // {1, 1}: '=Sum(B1:C9)' => A1: B1..C9
 };
 
 #endif  // !CELL_DEPENDENCIES_HANDLER_HPP
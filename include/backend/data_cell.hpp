@@ -7,34 +7,54 @@
 #include <memory>
 #include <string>
 
+#include "myt_lang/formula.hpp"
 #include "myt_lang/myt_object.hpp"
+#include "myt_lang/myt_value.hpp"
 
 class DataCell {
  public:
   DataCell() = delete;
   DataCell(const std::string& raw_content, MytObjectPtr value)
-      : m_raw_content(raw_content), m_evaluated_content(value) {};
-
-  [[nodiscard]] auto get_raw_content() const noexcept -> std::string;
+      : m_raw_content(raw_content),
+        m_evaluated_content(MytValue::from_object(value)) {};
+  DataCell(const std::string& raw_content,
+           MytObjectPtr value,
+           FormulaPtr formula)
+      : m_raw_content(raw_content),
+        m_evaluated_content(MytValue::from_object(value)),
+        m_formula(std::move(formula)) {};
+  DataCell(const std::string& raw_content, MytValue value, FormulaPtr formula)
+      : m_raw_content(raw_content),
+        m_evaluated_content(std::move(value)),
+        m_formula(std::move(formula)) {};
+
+  [[nodiscard]] auto get_raw_content() const noexcept -> const std::string&;
   auto set_raw_content(const std::string& value) noexcept -> void;
 
+  // Boxes inline values, prefer `get_value()` when reading
   [[nodiscard]] auto get_evaluated_content() const noexcept
       -> const MytObjectPtr;
+  [[nodiscard]] auto get_value() const noexcept -> const MytValue&;
   auto set_eval_content(MytObjectPtr&& value) noexcept -> void;
+  auto set_eval_content(MytValue&& value) noexcept -> void;
+
+  // Parsed `m_raw_content`, nullptr until compiled or after a text edit
+  [[nodiscard]] auto get_formula() const noexcept -> const FormulaPtr&;
 
   [[nodiscard]] auto to_string() const noexcept -> const std::string {
-    return (m_evaluated_content != nullptr) ? m_evaluated_content->to_string()
-                                            : "";
+    return m_evaluated_content.to_string();
   };
 
   void reset() noexcept {
     m_raw_content.clear();
-    m_evaluated_content = std::make_shared<NilObject>();
+    m_evaluated_content = MytValue{};
+    m_formula.reset();
   }
 
  private:
   std::string m_raw_content{};
-  MytObjectPtr m_evaluated_content{std::make_shared<NilObject>()};
+  MytValue m_evaluated_content{};
+  FormulaPtr m_formula{};
 };
 
 #endif  // !CELL_HPP
@@ -0,0 +1,35 @@
+#ifndef AGGREGATE_HPP
+#define AGGREGATE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "backend/myt_lang/myt_value.hpp"
+
+// Folds for the aggregate builtins. Range views are read straight from the
+// dense `CellBlock::numbers()` of the page, contiguous numbers go through
+// SIMD kernels picked once at startup, whole blocks of columns with an
+// `AggregateIndex` are read from the index. Sums are compensated in double
+// and only rounded to `FloatType` in the result.
+class Aggregate {
+ public:
+  enum class Op : uint8_t { Sum, Avg, Min, Max, Count, Product };
+  // Instruction sets of the kernels, `Scalar` runs everywhere
+  enum class Isa : uint8_t { Scalar, Sse2, Avx2 };
+
+  Aggregate() = delete;
+
+  // Int and float arguments, and the int and float cells of range and array
+  // arguments, anything else is skipped. Results stay ints while every
+  // number is an int and the result fits.
+  [[nodiscard]] static auto fold(const Op& op,
+                                 const std::vector<MytValue>& args) noexcept
+      -> MytValue;
+  [[nodiscard]] static auto fold(const Op& op,
+                                 const std::vector<MytValue>& args,
+                                 const Isa& isa) noexcept -> MytValue;
+  // Instruction sets this cpu runs, best first, `Isa::Scalar` last
+  [[nodiscard]] static auto supported() noexcept -> const std::vector<Isa>&;
+};
+
+#endif  // !AGGREGATE_HPP
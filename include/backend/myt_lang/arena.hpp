@@ -0,0 +1,49 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump allocator handing out memory from growing blocks, everything is
+// released at once with the arena. The arena never runs destructors, owners
+// of the objects destroy them in place.
+class Arena {
+ public:
+  static constexpr std::size_t INLINE_BYTES = 512;
+  static constexpr std::size_t MIN_BLOCK_BYTES = 4096;
+
+  explicit Arena()
+      : m_inline(),
+        m_cur(m_inline.data()),
+        m_end(m_inline.data() + m_inline.size()),
+        m_blocks() {}
+  Arena(const Arena&) = delete;
+  auto operator=(const Arena&) -> Arena& = delete;
+
+  [[nodiscard]] auto allocate(const std::size_t& size,
+                              const std::size_t& align) noexcept -> void*;
+
+  template <class T, class... Args>
+  [[nodiscard]] auto make(Args&&... args) -> T* {
+    return new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  // Heap blocks allocated on top of the inline one
+  [[nodiscard]] auto block_count() const noexcept -> std::size_t {
+    return m_blocks.size();
+  }
+
+ private:
+  alignas(std::max_align_t) std::array<std::byte, INLINE_BYTES> m_inline;
+  std::byte* m_cur;
+  std::byte* m_end;
+  std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+  std::size_t m_last_block_bytes{0};
+};
+
+#endif  // !ARENA_HPP
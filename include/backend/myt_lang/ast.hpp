@@ -5,11 +5,13 @@
 #include <iterator>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <type_traits>
-#include <typeinfo>
 #include <vector>
 
+#include "backend/myt_lang/builtin_id.hpp"
 #include "backend/myt_lang/cell_pos.hpp"
 #include "token.hpp"
 
@@ -17,9 +19,38 @@ class Expression;
 
 using FloatType = float;
 
-using ExpressionPtr = std::unique_ptr<Expression>;
+// Deletes heap allocated nodes, arena allocated ones are only destroyed and
+// their memory goes away with the arena
+struct ExpressionDeleter {
+  bool in_arena{false};
+
+  constexpr ExpressionDeleter() noexcept = default;
+  constexpr explicit ExpressionDeleter(const bool& in_arena) noexcept
+      : in_arena(in_arena) {}
+  template <class T>
+  constexpr ExpressionDeleter(const std::default_delete<T>&) noexcept {}
+
+  auto operator()(Expression* expr) const noexcept -> void;
+};
+
+using ExpressionPtr = std::unique_ptr<Expression, ExpressionDeleter>;
 using Arguments = std::vector<ExpressionPtr>;
 
+// Concrete type of an `Expression`, consumers dispatch on it through
+// `AstUtils::visit`
+enum class ExpressionKind : uint8_t {
+  IntLiteral,
+  FloatLiteral,
+  BoolLiteral,
+  StringLiteral,
+  Identifier,
+  Cell,
+  Prefix,
+  Infix,
+  CellRange,
+  FnCall,
+};
+
 enum class Precendence : uint8_t {
   Lowest,
   Equals,
@@ -34,8 +65,8 @@ enum class Precendence : uint8_t {
 namespace AstUtils {
 [[nodiscard]] auto token_to_precendece(const TokenType& type) noexcept
     -> Precendence;
-[[nodiscard]] auto same_hash_code(const Expression& lhs,
-                                  const Expression& rhs) noexcept -> bool;
+[[nodiscard]] auto same_kind(const Expression& lhs,
+                             const Expression& rhs) noexcept -> bool;
 }  // namespace AstUtils
 
 struct ParsingError {
@@ -44,6 +75,7 @@ struct ParsingError {
 
 class Expression {
  public:
+  explicit Expression(const ExpressionKind& kind) : m_kind(kind) {}
   virtual ~Expression() = default;
   virtual auto to_string() const -> std::string = 0;
   virtual auto equals(const Expression& other) const noexcept -> bool = 0;
@@ -51,6 +83,11 @@ class Expression {
   auto operator==(const Expression& other) const -> bool {
     return this->equals(other);
   }
+
+  [[nodiscard]] auto kind() const noexcept -> ExpressionKind { return m_kind; }
+
+ private:
+  ExpressionKind m_kind;
 };
 
 template <class ExprLiteralT,
@@ -63,7 +100,20 @@ class ExpressionLiteral : public Expression {
  public:
   ExpressionLiteral() = delete;
   ExpressionLiteral(const ExprLiteralT& value)
-      : Expression(), m_value(value) {};
+      : Expression(literal_kind()), m_value(value) {};
+
+  [[nodiscard]] static constexpr auto literal_kind() noexcept
+      -> ExpressionKind {
+    if constexpr (std::is_same_v<ExprLiteralT, bool>) {
+      return ExpressionKind::BoolLiteral;
+    } else if constexpr (std::is_same_v<ExprLiteralT, int>) {
+      return ExpressionKind::IntLiteral;
+    } else if constexpr (std::is_same_v<ExprLiteralT, FloatType>) {
+      return ExpressionKind::FloatLiteral;
+    } else {
+      return ExpressionKind::StringLiteral;
+    }
+  }
 
   auto to_string() const -> std::string override {
     if constexpr (std::is_same_v<ExprLiteralT, bool>) {
@@ -78,7 +128,7 @@ class ExpressionLiteral : public Expression {
   }
 
   auto equals(const Expression& other) const noexcept -> bool override {
-    if (!AstUtils::same_hash_code(*this, other)) return false;
+    if (!AstUtils::same_kind(*this, other)) return false;
     const auto other_literal =
         static_cast<const ExpressionLiteral<ExprLiteralT>*>(&other);
     return m_value == other_literal->get_value();
@@ -93,16 +143,15 @@ class ExpressionLiteral : public Expression {
 class ExpressionIdentifier : public Expression {
  public:
   ExpressionIdentifier() = delete;
-  ExpressionIdentifier(const Token& name_token) : m_name_token(name_token) {};
+  ExpressionIdentifier(const Token& name_token)
+      : Expression(ExpressionKind::Identifier), m_name_token(name_token) {};
 
   auto to_string() const -> std::string override {
     return "ident(" + m_name_token.literal + ")";
   }
 
   auto equals(const Expression& other) const noexcept -> bool override {
-    if (typeid(*this).hash_code() != typeid(other).hash_code()) {
-      return false;
-    }
+    if (!AstUtils::same_kind(*this, other)) return false;
     const auto other_ident = static_cast<const ExpressionIdentifier*>(&other);
     return m_name_token == other_ident->get_name_token();
   }
@@ -117,7 +166,8 @@ class ExpressionPrefix : public Expression {
  public:
   ExpressionPrefix() = delete;
   ExpressionPrefix(const Token& prefix_token, ExpressionPtr&& expression)
-      : m_prefix_token(std::move(prefix_token)),
+      : Expression(ExpressionKind::Prefix),
+        m_prefix_token(std::move(prefix_token)),
         m_expression(std::move(expression)) {};
 
   auto to_string() const -> std::string override {
@@ -125,9 +175,7 @@ class ExpressionPrefix : public Expression {
   };
 
   auto equals(const Expression& other) const noexcept -> bool override {
-    if (typeid(*this).hash_code() != typeid(other).hash_code()) {
-      return false;
-    }
+    if (!AstUtils::same_kind(*this, other)) return false;
     const auto other_prefix = static_cast<const ExpressionPrefix*>(&other);
     return m_prefix_token == other_prefix->get_prefix_token() &&
            *m_expression == other_prefix->get_expression();
@@ -150,9 +198,8 @@ class ExpressionInfix : public Expression {
   ExpressionInfix() = delete;
   ExpressionInfix(ExpressionPtr&& lhs, const Token& operator_token,
                   ExpressionPtr&& rhs)
-      : m_lhs(std::move(lhs)),
-        m_operator_token(operator_token),
-        m_rhs(std::move(rhs)) {};
+      : ExpressionInfix(ExpressionKind::Infix, std::move(lhs), operator_token,
+                        std::move(rhs)) {};
 
   auto to_string() const -> std::string override {
     return "infix(" + m_lhs->to_string() + m_operator_token.literal +
@@ -160,9 +207,7 @@ class ExpressionInfix : public Expression {
   };
 
   auto equals(const Expression& other) const noexcept -> bool override {
-    if (typeid(*this).hash_code() != typeid(other).hash_code()) {
-      return false;
-    }
+    if (!AstUtils::same_kind(*this, other)) return false;
     const auto other_infix = static_cast<const ExpressionInfix*>(&other);
     return *m_lhs == other_infix->get_lhs_expression() &&
            m_operator_token == other_infix->get_operator_token() &&
@@ -182,6 +227,13 @@ class ExpressionInfix : public Expression {
   }
 
  protected:
+  ExpressionInfix(const ExpressionKind& kind, ExpressionPtr&& lhs,
+                  const Token& operator_token, ExpressionPtr&& rhs)
+      : Expression(kind),
+        m_lhs(std::move(lhs)),
+        m_operator_token(operator_token),
+        m_rhs(std::move(rhs)) {};
+
   ExpressionPtr m_lhs;
   Token m_operator_token;
   ExpressionPtr m_rhs;
@@ -191,47 +243,74 @@ class ExpressionCellRange : public ExpressionInfix {
  public:
   ExpressionCellRange() = delete;
   ExpressionCellRange(ExpressionPtr&& lhs, const Token& op, ExpressionPtr&& rhs)
-      : ExpressionInfix(std::move(lhs), op, std::move(rhs)) {};
+      : ExpressionInfix(ExpressionKind::CellRange, std::move(lhs), op,
+                        std::move(rhs)),
+        m_bounds(resolve_bounds()) {};
 
   auto to_string() const -> std::string override {
     return "range(" + m_lhs->to_string() + m_operator_token.literal +
            m_rhs->to_string() + ")";
   };
 
+  [[nodiscard]] auto get_range_bounds() const noexcept
+      -> const std::optional<std::tuple<CellPos, CellPos>>& {
+    return m_bounds;
+  }
   [[nodiscard]] auto generate_range() const noexcept
       -> const std::vector<CellPos>;
   [[nodiscard]] auto get_cells_strs() const noexcept
       -> const std::tuple<std::string, std::string>;
+
+ private:
+  [[nodiscard]] auto resolve_bounds() const noexcept
+      -> std::optional<std::tuple<CellPos, CellPos>>;
+
+  // Ordered corners, resolved once from the cell operands
+  std::optional<std::tuple<CellPos, CellPos>> m_bounds;
 };
 
 class ExpressionCell : public Expression {
  public:
   ExpressionCell() = delete;
-  ExpressionCell(const Token& cell_token) : m_cell_token(cell_token) {};
+  // Throws `InvalidCellString` when `cell_token` is out of the cell range
+  ExpressionCell(const Token& cell_token)
+      : ExpressionCell(cell_token, CellPos{cell_token.literal}) {};
+  ExpressionCell(const Token& cell_token, const CellPos& pos)
+      : Expression(ExpressionKind::Cell),
+        m_cell_token(cell_token),
+        m_pos(pos) {};
 
   auto to_string() const -> std::string override {
     return "cell(" + m_cell_token.literal + ")";
   };
 
   auto equals(const Expression& other) const noexcept -> bool override {
-    if (!AstUtils::same_hash_code(*this, other)) return false;
+    if (!AstUtils::same_kind(*this, other)) return false;
 
     const auto other_cell = static_cast<const ExpressionCell*>(&other);
     return m_cell_token == other_cell->get_cell_token();
   }
 
-  const Token get_cell_token() const noexcept { return m_cell_token; };
+  auto get_cell_token() const noexcept -> const Token& {
+    return m_cell_token;
+  };
+  auto get_pos() const noexcept -> const CellPos& { return m_pos; };
 
  private:
   Token m_cell_token{};
+  CellPos m_pos;
 };
 
 class ExpressionFnCall : public Expression {
  public:
   ExpressionFnCall() = delete;
-  ExpressionFnCall(ExpressionPtr&& fn_identifier, Arguments&& arguments)
-      : m_fn_identifier(std::move(fn_identifier)),
-        m_arguments(std::move(arguments)) {}
+  ExpressionFnCall(ExpressionPtr&& fn_identifier,
+                   Arguments&& arguments,
+                   const std::optional<BuiltinId>& builtin = std::nullopt)
+      : Expression(ExpressionKind::FnCall),
+        m_fn_identifier(std::move(fn_identifier)),
+        m_arguments(std::move(arguments)),
+        m_builtin(builtin) {}
 
   auto to_string() const -> std::string override {
     constexpr auto comma_sep_fold = [](const auto& lhs, const auto& arg_expr) {
@@ -248,7 +327,7 @@ class ExpressionFnCall : public Expression {
   };
 
   auto equals(const Expression& other) const noexcept -> bool override {
-    if (!AstUtils::same_hash_code(*this, other)) return false;
+    if (!AstUtils::same_kind(*this, other)) return false;
     return this->to_string() == other.to_string();
   }
 
@@ -260,9 +339,54 @@ class ExpressionFnCall : public Expression {
     return m_arguments;
   }
 
+  // Set by the parser for calls by name, `std::nullopt` otherwise
+  auto get_builtin() const noexcept -> const std::optional<BuiltinId>& {
+    return m_builtin;
+  }
+
  private:
   ExpressionPtr m_fn_identifier;
   Arguments m_arguments;
+  std::optional<BuiltinId> m_builtin;
 };
 
+namespace AstUtils {
+// Calls `visitor(node)` with `expr` cast to its concrete node type, a single
+// switch on `Expression::kind()`
+template <class Visitor>
+auto visit(const Expression& expr, Visitor&& visitor) -> decltype(auto) {
+  switch (expr.kind()) {
+    case ExpressionKind::IntLiteral:
+      return visitor(static_cast<const ExpressionLiteral<int>&>(expr));
+    case ExpressionKind::FloatLiteral:
+      return visitor(static_cast<const ExpressionLiteral<FloatType>&>(expr));
+    case ExpressionKind::BoolLiteral:
+      return visitor(static_cast<const ExpressionLiteral<bool>&>(expr));
+    case ExpressionKind::StringLiteral:
+      return visitor(static_cast<const ExpressionLiteral<std::string>&>(expr));
+    case ExpressionKind::Identifier:
+      return visitor(static_cast<const ExpressionIdentifier&>(expr));
+    case ExpressionKind::Cell:
+      return visitor(static_cast<const ExpressionCell&>(expr));
+    case ExpressionKind::Prefix:
+      return visitor(static_cast<const ExpressionPrefix&>(expr));
+    case ExpressionKind::Infix:
+      return visitor(static_cast<const ExpressionInfix&>(expr));
+    case ExpressionKind::CellRange:
+      return visitor(static_cast<const ExpressionCellRange&>(expr));
+    case ExpressionKind::FnCall:
+      break;
+  }
+  return visitor(static_cast<const ExpressionFnCall&>(expr));
+}
+
+// Set of lambdas usable as one `visit` visitor
+template <class... Fns>
+struct Overloaded : Fns... {
+  using Fns::operator()...;
+};
+template <class... Fns>
+Overloaded(Fns...) -> Overloaded<Fns...>;
+}  // namespace AstUtils
+
 #endif  // !AST_HPP
@@ -0,0 +1,30 @@
+#ifndef BUILTIN_ID_HPP
+#define BUILTIN_ID_HPP
+
+#include <cstdint>
+
+// Index into the `MytBuiltins` registry, resolved when a call is parsed
+enum class BuiltinId : uint8_t {
+  // NO ARGS
+  Pi,
+
+  // ONE ARG
+  Sqrt,
+
+  // MANY ARGS
+  Sum,
+  Avg,
+  Min,
+  Max,
+  Count,
+  Product,
+
+  // LAZY
+  If,
+  And,
+  Or,
+  IfError,
+  Choose,
+};
+
+#endif  // !BUILTIN_ID_HPP
@@ -0,0 +1,64 @@
+#ifndef BYTECODE_HPP
+#define BYTECODE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "backend/myt_lang/ast.hpp"
+#include "backend/myt_lang/cell_pos.hpp"
+#include "backend/myt_lang/myt_value.hpp"
+
+enum class OpCode : uint8_t {
+  PushConst,    // operand: index in `Program::constants`
+  LoadCell,     // operand: index in `Program::cells`
+  LoadRange,    // operand: index in `Program::ranges`
+  Neg,
+  Not,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Eq,
+  NotEq,
+  Gt,
+  Ge,
+  Lt,
+  Le,
+  CallBuiltin,  // operand: `BuiltinId`, argc: arguments
+
+  // Control flow of lazy builtins, jump operands are indexes in `code`
+  ToBool,           // operand: `BuiltinId` named in type errors
+  Jump,             // operand: target
+  JumpIfFalse,      // operand: target, pops the bool
+  JumpIfTrue,       // operand: target, pops the bool
+  JumpIfError,      // operand: target, keeps the value
+  JumpUnlessError,  // operand: target, keeps the value
+  Pop,
+  Switch,  // operand: index in `Program::jump_tables`, argc: choices
+};
+
+struct Instruction {
+  OpCode op;
+  uint16_t argc{0};
+  uint32_t operand{0};
+};
+
+struct RangeOperand {
+  CellPos begin;
+  CellPos end;
+  std::string range_str{};
+};
+
+struct Program {
+  std::vector<Instruction> code{};
+  std::vector<MytValue> constants{};
+  std::vector<CellPos> cells{};
+  std::vector<RangeOperand> ranges{};
+  // Targets of each choice and the end target last, errors jump to the end
+  std::vector<std::vector<uint32_t>> jump_tables{};
+  std::size_t max_stack{0};
+};
+
+#endif  // !BYTECODE_HPP
@@ -24,21 +24,14 @@ class InvalidCellString : public std::exception {
 
 struct CellPos {
   CellPos() = delete;
-  CellPos(const CellLimitType& col, const CellLimitType& row)
+  constexpr CellPos(const CellLimitType& col, const CellLimitType& row)
       : col(col), row(row) {};
-  CellPos(const std::string_view& valid_format_str) {
-    auto it = valid_format_str.begin();
-    std::size_t len{0};
-    while (std::isalpha(*it++)) {
-      len++;
-    }
-    const std::string_view letters =
-        std::string_view{valid_format_str.begin(), len};
-    col = CellPos::convert_letters(valid_format_str, letters);
-    const std::string_view numbers = std::string_view{
-        valid_format_str.begin() + len, valid_format_str.size() - len};
-    row = CellPos::convert_number(valid_format_str, numbers);
-  };
+  // Parses A1 notation without allocating, throws `InvalidCellString` when
+  // a coordinate is out of the cell range
+  CellPos(const std::string_view& valid_format_str);
+
+  // Longest A1 string, `CRXO65535`
+  static constexpr std::size_t MAX_A1_LENGTH = 9;
 
   CellLimitType col{};
   CellLimitType row{};
@@ -59,22 +52,55 @@ struct CellPos {
     return (*this < other) || (*this == other);
   }
 
+  // Both coordinates packed into one integer, column in the high half
+  [[nodiscard]] constexpr auto key() const noexcept -> uint32_t {
+    return (static_cast<uint32_t>(col) << 16) | row;
+  }
+  [[nodiscard]] static constexpr auto from_key(const uint32_t& key) noexcept
+      -> CellPos {
+    return CellPos{static_cast<CellLimitType>(key >> 16),
+                   static_cast<CellLimitType>(key & 0xFFFF)};
+  }
+
+  // Writes the A1 form, at most `MAX_A1_LENGTH` chars, returns its length
+  auto to_chars(char* out) const noexcept -> std::size_t;
   [[nodiscard]] auto to_string() const noexcept -> const std::string;
+};
 
- private:
-  [[nodiscard]] auto convert_letters(const std::string_view& valid_format_str,
-                                     const std::string_view& letters) const
-      -> CellLimitType;
-  [[nodiscard]] auto convert_number(const std::string_view& valid_format_str,
-                                    const std::string_view& number) const
-      -> CellLimitType;
+// Signed distance between two cells, the relative part of an R1C1 reference
+struct CellOffset {
+  int32_t col{0};
+  int32_t row{0};
+
+  [[nodiscard]] static constexpr auto between(const CellPos& from,
+                                              const CellPos& to) noexcept
+      -> CellOffset {
+    return CellOffset{static_cast<int32_t>(to.col) - from.col,
+                      static_cast<int32_t>(to.row) - from.row};
+  }
+  [[nodiscard]] constexpr auto is_zero() const noexcept -> bool {
+    return col == 0 && row == 0;
+  }
+  // Callers guarantee the shifted cell stays inside the cell range
+  [[nodiscard]] constexpr auto apply(const CellPos& pos) const noexcept
+      -> CellPos {
+    return CellPos{static_cast<CellLimitType>(pos.col + col),
+                   static_cast<CellLimitType>(pos.row + row)};
+  }
 };
 
+// Murmur3 finalizer over the packed key, so neighbouring cells of a block
+// spread over the whole bucket range
 template <>
 struct std::hash<CellPos> {
-  auto operator()(const CellPos& pos) const -> std::size_t {
-    return std::hash<CellLimitType>()(pos.row) ^
-           (std::hash<CellLimitType>()(pos.col) << 1);
+  auto operator()(const CellPos& pos) const noexcept -> std::size_t {
+    auto h = static_cast<uint64_t>(pos.key());
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h);
   }
 };
 
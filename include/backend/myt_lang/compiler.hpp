@@ -0,0 +1,73 @@
+#ifndef COMPILER_HPP
+#define COMPILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "backend/myt_lang/ast.hpp"
+#include "backend/myt_lang/builtin_id.hpp"
+#include "backend/myt_lang/bytecode.hpp"
+#include "backend/myt_lang/parser.hpp"
+
+// Flattens an `Expression` tree into a `Program` for `Vm`. Returns
+// `std::nullopt` for trees the VM doesn't cover, those stay on `Evaluator`.
+// Operations over constants only are folded into a single constant.
+class Compiler {
+ public:
+  Compiler() = delete;
+
+  [[nodiscard]] static auto compile(const ParsingResult& parsed) noexcept
+      -> std::optional<Program>;
+
+ private:
+  struct Context {
+    Program program{};
+    std::size_t depth{0};
+    // Jump targets are at or below this index, folding can't cross it
+    std::size_t fold_floor{0};
+  };
+  using Jumps = std::vector<std::size_t>;
+
+  [[nodiscard]] static auto compile_expression(const Expression& expr,
+                                               Context& ctx) noexcept -> bool;
+  [[nodiscard]] static auto compile_prefix(
+      const ExpressionPrefix& expr_prefix, Context& ctx) noexcept -> bool;
+  [[nodiscard]] static auto compile_cell_range(
+      const ExpressionCellRange& expr_range, Context& ctx) noexcept -> bool;
+  [[nodiscard]] static auto compile_infix(const ExpressionInfix& expr_infix,
+                                          Context& ctx) noexcept -> bool;
+  [[nodiscard]] static auto compile_fn_call(
+      const ExpressionFnCall& expr_fn_call,
+      Context& ctx) noexcept -> bool;
+  // Lazy builtins become jumps around their arguments
+  [[nodiscard]] static auto compile_lazy_call(
+      const BuiltinId& builtin,
+      const Arguments& args_expr,
+      Context& ctx) noexcept -> bool;
+  [[nodiscard]] static auto compile_condition(const BuiltinId& builtin,
+                                              const Expression& expr,
+                                              Jumps& error_jumps,
+                                              Context& ctx) noexcept -> bool;
+
+  static auto emit_op(Context& ctx,
+                      const OpCode& op,
+                      const std::size_t& operand,
+                      const std::size_t& n_pops = 0,
+                      const uint16_t& argc = 0) noexcept -> void;
+  static auto emit_const(Context& ctx, MytValue&& value) noexcept -> void;
+  // Returns the jump's index, its target is set by `bind_jumps`
+  static auto emit_jump(Context& ctx,
+                        const OpCode& op,
+                        const std::size_t& n_pops = 0) noexcept
+      -> std::size_t;
+  // Points `jumps` at the next emitted instruction
+  static auto bind_jumps(Context& ctx, const Jumps& jumps) noexcept -> void;
+  // Replaces the last emitted op by its result when its `n_operands` inputs
+  // are all constants, evaluated on `Vm` so folding can't drift from runtime
+  static auto fold_constants(Context& ctx,
+                             const std::size_t& n_operands) noexcept -> void;
+};
+
+#endif  // !COMPILER_HPP
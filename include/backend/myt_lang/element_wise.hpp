@@ -0,0 +1,41 @@
+#ifndef ELEMENT_WISE_HPP
+#define ELEMENT_WISE_HPP
+
+#include "backend/myt_lang/myt_object.hpp"
+#include "backend/myt_lang/myt_value.hpp"
+
+// Binary operators over ranges and arrays. Lanes where both sides are
+// numbers (or bools for comparisons) run through branch free loops over the
+// dense `ArrayObject` buffers, scalars are broadcast to every lane. Any other
+// lane falls back to the scalar `MytValue` operator, so every element
+// matches what the operator gives on the single values.
+class ElementWise {
+ public:
+  ElementWise() = delete;
+
+  // Ranges and arrays are computed element-wise
+  [[nodiscard]] static auto is_array(const MytValue& value) noexcept -> bool;
+  // Both array sides need the same number of elements
+  [[nodiscard]] static auto apply(const BinaryOp& op,
+                                  const MytValue& lhs,
+                                  const MytValue& rhs) noexcept -> MytValue;
+  [[nodiscard]] static auto apply(const BinaryOp& op,
+                                  const ArrayObject& lhs,
+                                  const MytValue& rhs) noexcept -> MytValue;
+
+ private:
+  [[nodiscard]] static auto apply(const BinaryOp& op,
+                                  const ArrayObject* lhs_array,
+                                  const MytValue& lhs,
+                                  const ArrayObject* rhs_array,
+                                  const MytValue& rhs) noexcept -> MytValue;
+  // Scalar operator on the `Kind::Other` lanes left by the fast loops
+  static auto fill_other_lanes(const BinaryOp& op,
+                               const ArrayObject* lhs_array,
+                               const MytValue& lhs,
+                               const ArrayObject* rhs_array,
+                               const MytValue& rhs,
+                               ArrayObject& result) noexcept -> void;
+};
+
+#endif  // !ELEMENT_WISE_HPP
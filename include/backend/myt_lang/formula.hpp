@@ -0,0 +1,72 @@
+#ifndef FORMULA_HPP
+#define FORMULA_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "backend/myt_lang/bytecode.hpp"
+#include "backend/myt_lang/cell_pos.hpp"
+#include "backend/myt_lang/myt_value.hpp"
+#include "backend/myt_lang/parser.hpp"
+
+class Page;
+
+class Formula;
+
+using FormulaPtr = std::shared_ptr<const Formula>;
+
+// Parsed and compiled form of a cell's raw content, kept next to the raw
+// text so recalculation doesn't lex and parse unchanged content again.
+// Evaluates on `Vm` and falls back to `Evaluator` when there's no program.
+//
+// Formulas compiled for a cell are interned by their R1C1 shape, so a filled
+// down column (`=A2*B2`, `=A3*B3`, ...) shares the formula of its first cell
+// and every cell evaluates it shifted by its offset from that `origin`.
+class Formula {
+ public:
+  Formula() = delete;
+  explicit Formula(ParsingResult&& parsed,
+                   const std::optional<CellPos>& origin = std::nullopt);
+
+  // Unanchored, always evaluated as written
+  [[nodiscard]] static auto compile(
+      const std::string_view& raw_content) noexcept -> FormulaPtr;
+  // Shared with every live formula of the same shape
+  [[nodiscard]] static auto compile(const std::string_view& raw_content,
+                                    const CellPos& anchor) noexcept
+      -> FormulaPtr;
+
+  [[nodiscard]] auto get_parsed() const noexcept -> const ParsingResult& {
+    return m_parsed;
+  }
+  [[nodiscard]] auto get_program() const noexcept
+      -> const std::optional<Program>& {
+    return m_program;
+  }
+  // Shift from the cells written in the formula to the ones `anchor` reads
+  [[nodiscard]] auto offset_to(const CellPos& anchor) const noexcept
+      -> CellOffset;
+  [[nodiscard]] auto evaluate(const Page& page) const noexcept -> MytValue;
+  [[nodiscard]] auto evaluate(const Page& page,
+                              const CellPos& anchor) const noexcept
+      -> MytValue;
+
+ private:
+  // Cell references relative to `anchor`, everything else verbatim.
+  // `std::nullopt` for text cells and when a reference is out of the cell
+  // range.
+  [[nodiscard]] static auto shape_key(const std::vector<TokenView>& tokens,
+                                      const CellPos& anchor) noexcept
+      -> std::optional<std::string>;
+  // Only VM programs can be shifted, errors may quote cell literals
+  [[nodiscard]] auto is_shareable() const noexcept -> bool;
+
+  ParsingResult m_parsed;
+  std::optional<Program> m_program;
+  std::optional<CellPos> m_origin;
+};
+
+#endif  // !FORMULA_HPP
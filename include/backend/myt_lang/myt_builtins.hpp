@@ -1,72 +1,189 @@
 #ifndef MYT_BUILTIS_HPP
 #define MYT_BUILTIS_HPP
 
-#include <functional>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
+#include "backend/myt_lang/builtin_id.hpp"
 #include "backend/myt_lang/myt_object.hpp"
+#include "backend/myt_lang/myt_value.hpp"
 
-#define NOT_IMPL_BUILTIN_FN_ERR(value)                              \
-  std::make_shared<ErrorObject>("Unimplemented function named: `" + \
-                                std::string(value) + "`")
-#define N_ARGS_ERR(value, n_want, n_got)                               \
-  std::make_shared<ErrorObject>("Function: `" + std::string(value) +   \
-                                "` takes: " + std::to_string(n_want) + \
-                                " arguments, got: " + std::to_string(n_got))
+#define NOT_IMPL_BUILTIN_FN_ERR(value)                \
+  MytValue::error("Unimplemented function named: `" + \
+                  std::string(value) + "`")
+#define N_ARGS_ERR(value, n_want, n_got)                             \
+  MytValue::error("Function: `" + std::string(value) + "` takes: " + \
+                  std::to_string(n_want) +                           \
+                  " arguments, got: " + std::to_string(n_got))
 #define N_STR_ARGS_ERR(value, n_want, n_got)                         \
-  std::make_shared<ErrorObject>("Function: `" + std::string(value) + \
-                                "` takes: " + n_want +               \
-                                " arguments, got: " + std::to_string(n_got))
-#define WRONG_TYPE_ERR(value, want_type, got_type)                      \
-  std::make_shared<ErrorObject>(                                        \
-      "Wrong type in function: `" + std::string(value) + "` wants: `" + \
-      std::string(want_type) + "` got: `" + std::string(got_type) + "`")
+  MytValue::error("Function: `" + std::string(value) + "` takes: " + \
+                  n_want + " arguments, got: " + std::to_string(n_got))
+#define WRONG_TYPE_ERR(value, want_type, got_type)                     \
+  MytValue::error("Wrong type in function: `" + std::string(value) +   \
+                  "` wants: `" + std::string(want_type) + "` got: `" + \
+                  std::string(got_type) + "`")
 
 #define DP_CAST_VO_T(T, value) std::dynamic_pointer_cast<ValueObject<T>>(value)
 #define DP_CAST_T(T, value) std::dynamic_pointer_cast<T>(value)
 
-using MytObjectArgs = std::vector<MytObjectPtr>;
-using BuiltinFn = std::function<MytObjectPtr(const MytObjectArgs&)>;
+using MytValueArgs = std::vector<MytValue>;
+using BuiltinFn = MytValue (*)(const MytValueArgs&) noexcept;
+
+// Type every argument of a builtin has to have, checked before the call
+enum class ArgType : uint8_t {
+  Any,
+  Number,
+};
+
+// Lazy builtins have no `fn`, they pull their arguments through `call_lazy`
+// so untaken branches are never evaluated
+struct Builtin {
+  BuiltinId id;
+  std::string_view name;
+  BuiltinFn fn;
+  std::size_t min_args;
+  std::size_t max_args;
+  ArgType arg_type;
+  bool lazy{false};
+};
 
 class MytBuiltins {
  public:
   MytBuiltins() = delete;
 
+  static constexpr auto VARIADIC = std::numeric_limits<std::size_t>::max();
+
+  [[nodiscard]] static constexpr auto find(const std::string_view& fn_name)
+      -> std::optional<BuiltinId> {
+    for (const auto& builtin : REGISTRY) {
+      if (builtin.name == fn_name) {
+        return builtin.id;
+      }
+    }
+    return std::nullopt;
+  }
+  [[nodiscard]] static constexpr auto get(const BuiltinId& id) noexcept
+      -> const Builtin& {
+    return REGISTRY[static_cast<std::size_t>(id)];
+  }
+  // Message of the arity error, `std::nullopt` when `argc` fits
+  [[nodiscard]] static auto check_arity(const BuiltinId& id,
+                                        const std::size_t& argc) noexcept
+      -> std::optional<std::string>;
+  // Checks arity and argument types, then calls through the registry
+  [[nodiscard]] static auto call(const BuiltinId& id,
+                                 const MytValueArgs& args) noexcept
+      -> MytValue;
+  // Name based call for trees built without the parser
   [[nodiscard]] static auto exec(const std::string& fn_name,
-                                 const MytObjectArgs& args) noexcept
-      -> MytObjectPtr;
+                                 const MytValueArgs& args) noexcept
+      -> MytValue;
 
- private:
-  [[nodiscard]] static auto is_in_builtins(const std::string& fn_name) noexcept
-      -> bool {
-    return MytBuiltins::BuiltinFns.find(fn_name) !=
-           MytBuiltins::BuiltinFns.end();
+  // `arg(i)` evaluates the i-th of the `argc` arguments, only called for
+  // the arguments the result depends on
+  template <typename ArgFn>
+  [[nodiscard]] static auto call_lazy(const BuiltinId& id,
+                                      const std::size_t& argc,
+                                      ArgFn&& arg) noexcept -> MytValue {
+    switch (id) {
+      case BuiltinId::If: {
+        const auto cond = to_condition(id, arg(0));
+        if (cond.is_error()) {
+          return cond;
+        }
+        if (cond.get_bool()) {
+          return arg(1);
+        }
+        return argc > 2 ? arg(2) : MytValue::from_bool(false);
+      }
+      case BuiltinId::And:
+      case BuiltinId::Or: {
+        const auto short_circuit = id == BuiltinId::Or;
+        for (std::size_t i{0}; i < argc; ++i) {
+          const auto cond = to_condition(id, arg(i));
+          if (cond.is_error() || cond.get_bool() == short_circuit) {
+            return cond;
+          }
+        }
+        return MytValue::from_bool(!short_circuit);
+      }
+      case BuiltinId::IfError: {
+        auto value = arg(0);
+        return value.is_error() ? arg(1) : value;
+      }
+      case BuiltinId::Choose: {
+        const auto choice = to_choice(arg(0), argc - 1);
+        if (choice.is_error()) {
+          return choice;
+        }
+        return arg(static_cast<std::size_t>(choice.get_int()));
+      }
+      default:
+        return NOT_IMPL_BUILTIN_FN_ERR(get(id).name);
+    }
   }
+  // Bool value of a condition argument of `id`, numbers are true unless
+  // zero and Nil is false. Errors pass through.
+  [[nodiscard]] static auto to_condition(const BuiltinId& id,
+                                         const MytValue& value) noexcept
+      -> MytValue;
+  // `Choose` index as an int in [1, n_choices], numbers are truncated
+  [[nodiscard]] static auto to_choice(const MytValue& index,
+                                      const std::size_t& n_choices) noexcept
+      -> MytValue;
 
+ private:
   // NO ARGS
   [[nodiscard]] static auto m_pi(
-      [[maybe_unused]] const MytObjectArgs& args) noexcept -> MytObjectPtr;
+      [[maybe_unused]] const MytValueArgs& args) noexcept -> MytValue;
 
   // ONE ARG
-  [[nodiscard]] static auto m_sqrt(const MytObjectArgs& args) noexcept
-      -> MytObjectPtr;
+  [[nodiscard]] static auto m_sqrt(const MytValueArgs& args) noexcept
+      -> MytValue;
 
-  // MANY ARGS
-  [[nodiscard]] static auto m_sum(const MytObjectArgs& args) noexcept
-      -> MytObjectPtr;
+  // MANY ARGS, folded by `Aggregate`
+  [[nodiscard]] static auto m_sum(const MytValueArgs& args) noexcept
+      -> MytValue;
+  [[nodiscard]] static auto m_avg(const MytValueArgs& args) noexcept
+      -> MytValue;
+  [[nodiscard]] static auto m_min(const MytValueArgs& args) noexcept
+      -> MytValue;
+  [[nodiscard]] static auto m_max(const MytValueArgs& args) noexcept
+      -> MytValue;
+  [[nodiscard]] static auto m_count(const MytValueArgs& args) noexcept
+      -> MytValue;
+  [[nodiscard]] static auto m_product(const MytValueArgs& args) noexcept
+      -> MytValue;
 
-  inline static const std::unordered_map<std::string, BuiltinFn> BuiltinFns{
+  // Ordered by `BuiltinId`
+  static constexpr std::array<Builtin, 13> REGISTRY{{
       // NO ARGS
-      {"Pi", m_pi},
+      {BuiltinId::Pi, "Pi", m_pi, 0, 0, ArgType::Any},
 
       // ONE ARG
-      {"Sqrt", m_sqrt},
+      {BuiltinId::Sqrt, "Sqrt", m_sqrt, 1, 1, ArgType::Number},
 
       // MANY ARGS
-      {"Sum", m_sum},
-  };
+      {BuiltinId::Sum, "Sum", m_sum, 1, VARIADIC, ArgType::Any},
+      {BuiltinId::Avg, "Avg", m_avg, 1, VARIADIC, ArgType::Any},
+      {BuiltinId::Min, "Min", m_min, 1, VARIADIC, ArgType::Any},
+      {BuiltinId::Max, "Max", m_max, 1, VARIADIC, ArgType::Any},
+      {BuiltinId::Count, "Count", m_count, 1, VARIADIC, ArgType::Any},
+      {BuiltinId::Product, "Product", m_product, 1, VARIADIC, ArgType::Any},
+
+      // LAZY
+      {BuiltinId::If, "If", nullptr, 2, 3, ArgType::Any, true},
+      {BuiltinId::And, "And", nullptr, 1, VARIADIC, ArgType::Any, true},
+      {BuiltinId::Or, "Or", nullptr, 1, VARIADIC, ArgType::Any, true},
+      {BuiltinId::IfError, "IfError", nullptr, 2, 2, ArgType::Any, true},
+      {BuiltinId::Choose, "Choose", nullptr, 2, VARIADIC, ArgType::Any, true},
+  }};
 };
 
 #endif  // !MYT_BUILTIS_HPP
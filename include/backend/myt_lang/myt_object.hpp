@@ -1,22 +1,28 @@
 #ifndef MYT_OBJECT_HPP
 #define MYT_OBJECT_HPP
 
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
 #include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
 #include "backend/myt_lang/ast.hpp"
+#include "backend/myt_lang/cell_pos.hpp"
+#include "backend/myt_lang/myt_value.hpp"
 
 #define MS_VO_T(T, value) std::make_shared<ValueObject<T>>(value)
 #define MS_T(T, value) std::make_shared<T>(value)
 #define D_CAST(T, expr) dynamic_cast<const T*>(expr)
 
-class MytObject;
-
-using MytObjectPtr = std::shared_ptr<MytObject>;
+class Page;
 
 class MytObject {
  public:
@@ -26,11 +32,23 @@ class MytObject {
   auto operator==(const MytObject& other) const noexcept -> bool {
     return this->to_string() == other.to_string();
   }
+  // Same type and value, objects without an override compare `to_string()`
+  [[nodiscard]] virtual auto equals(const MytObject& other) const noexcept
+      -> bool {
+    return this->to_string() == other.to_string();
+  }
 
   virtual auto add(MytObjectPtr other) const noexcept -> MytObjectPtr = 0;
   virtual auto sub(MytObjectPtr other) const noexcept -> MytObjectPtr = 0;
   virtual auto mul(MytObjectPtr other) const noexcept -> MytObjectPtr = 0;
   virtual auto div(MytObjectPtr other) const noexcept -> MytObjectPtr = 0;
+
+ private:
+  friend class MytValue;
+
+  // `MytValue`s holding this object, `m_self` owns it while there are any
+  mutable std::atomic<uint32_t> m_value_refs{0};
+  mutable MytObjectPtr m_self{};
 };
 
 class ErrorObject : public MytObject {
@@ -41,6 +59,11 @@ class ErrorObject : public MytObject {
   [[nodiscard]] auto to_string() const noexcept -> const std::string override {
     return "Error: " + m_value;
   };
+  [[nodiscard]] auto equals(const MytObject& other) const noexcept
+      -> bool override {
+    const auto error = D_CAST(ErrorObject, &other);
+    return error != nullptr && error->m_value == m_value;
+  }
 
   auto add([[maybe_unused]] MytObjectPtr other) const noexcept
       -> MytObjectPtr override {
@@ -69,6 +92,10 @@ class NilObject : public MytObject {
   [[nodiscard]] auto to_string() const noexcept -> const std::string override {
     return "Nil";
   };
+  [[nodiscard]] auto equals(const MytObject& other) const noexcept
+      -> bool override {
+    return D_CAST(NilObject, &other) != nullptr;
+  }
 
   auto add([[maybe_unused]] MytObjectPtr other) const noexcept
       -> MytObjectPtr override {
@@ -114,6 +141,19 @@ class ValueObject : public MytObject {
     }
     assert(false && "Unreachable");
   };
+  // `IdentObject`s only equal `IdentObject`s
+  [[nodiscard]] auto equals(const MytObject& other) const noexcept
+      -> bool override {
+    if (typeid(other) != typeid(*this)) {
+      return false;
+    }
+    const auto& value = static_cast<const ValueObject&>(other).m_value;
+    if constexpr (std::is_same_v<ObjectType, FloatType>) {
+      return MytValue::same_number(m_value, value);
+    } else {
+      return m_value == value;
+    }
+  }
 
 #define LAMBDA_OP(op) [](const auto& a, const auto& b) { return a op b; }, "op"
 
@@ -176,7 +216,14 @@ class ValueObject : public MytObject {
       } else if (auto int_obj = D_CAST(ValueObject<int>, other.get())) {
         const auto a = m_value;
         const auto b = int_obj->get_value();
-        return MS_VO_T(int, op(a, b));
+        // Results out of the `int` range become floats
+        const auto wide = op(int64_t{a}, int64_t{b});
+        if (wide < std::numeric_limits<int>::min() ||
+            wide > std::numeric_limits<int>::max()) {
+          return MS_VO_T(FloatType, op(static_cast<FloatType>(a),
+                                       static_cast<FloatType>(b)));
+        }
+        return MS_VO_T(int, static_cast<int>(wide));
       }
     }
     return std::nullopt;
@@ -193,51 +240,116 @@ class IdentObject : public ValueObject<std::string> {
   };
 };
 
+// Either a lazy view of a rectangle of a `Page`, read in place while the
+// page is alive and unchanged, or a detached copy of its cells. Evaluation
+// results are detached before they outlive the page, see `detach()`.
 class CellRangeObject : public MytObject {
  public:
   CellRangeObject() = delete;
+  explicit CellRangeObject(const std::string& range_str,
+                           const Page& page,
+                           const CellPos& begin,
+                           const CellPos& end)
+      : m_range_str(range_str),
+        m_page(&page),
+        m_begin(begin),
+        m_end(end),
+        m_cells_range() {};
+  explicit CellRangeObject(const std::string& range_str,
+                           std::vector<MytValue> cells_range)
+      : m_range_str(range_str), m_cells_range(std::move(cells_range)) {};
   explicit CellRangeObject(const std::string& range_str,
                            const std::vector<MytObjectPtr>& cells_range)
-      : m_range_str(range_str), m_cells_range(cells_range) {};
+      : m_range_str(range_str), m_cells_range() {
+    m_cells_range.reserve(cells_range.size());
+    for (const auto& obj : cells_range) {
+      m_cells_range.push_back(MytValue::from_object(obj));
+    }
+  };
 
-  auto to_string() const noexcept -> const std::string override {
-    auto new_line_fold = [](std::string lhs, const MytObjectPtr& obj) {
-      return std::move(lhs) + "; " + obj->to_string();
-    };
-    const auto args =
-        std::accumulate(std::next(m_cells_range.begin()), m_cells_range.end(),
-                        m_cells_range[0]->to_string(), new_line_fold);
-    return m_range_str + " ( " + args + " )";
-  }
+  auto to_string() const noexcept -> const std::string override;
+  // Same range string and cells
+  [[nodiscard]] auto equals(const MytObject& other) const noexcept
+      -> bool override;
 
-  auto add([[maybe_unused]] MytObjectPtr other) const noexcept
-      -> MytObjectPtr override {
-    return std::make_shared<ErrorObject>("Cell range add not supported yet");
-  }
+  // Element-wise, see `ElementWise`
+  auto add(MytObjectPtr other) const noexcept -> MytObjectPtr override;
+  auto sub(MytObjectPtr other) const noexcept -> MytObjectPtr override;
+  auto mul(MytObjectPtr other) const noexcept -> MytObjectPtr override;
+  auto div(MytObjectPtr other) const noexcept -> MytObjectPtr override;
 
-  auto sub([[maybe_unused]] MytObjectPtr other) const noexcept
-      -> MytObjectPtr override {
-    return std::make_shared<ErrorObject>("Cell range sub not supported yet");
-  }
+  // Views of a page keep a detached copy of the cells, anything else is
+  // returned as is
+  [[nodiscard]] static auto detach(MytValue value) noexcept -> MytValue;
 
-  auto mul([[maybe_unused]] MytObjectPtr other) const noexcept
-      -> MytObjectPtr override {
-    return std::make_shared<ErrorObject>("Can't mul cells range");
+  [[nodiscard]] auto is_view() const noexcept -> bool {
+    return m_page != nullptr;
   }
+  [[nodiscard]] auto size() const noexcept -> std::size_t;
+  // Every cell column by column, Nil for empty cells
+  [[nodiscard]] auto get_values() const noexcept -> std::vector<MytValue>;
+
+  // Calls `fn(idx, value)` for every cell that isn't Nil, `idx` counting
+  // cells column by column. Views only visit the cells stored in the page.
+  // Defined in page.hpp.
+  template <typename Fn>
+  auto for_each_occupied(Fn&& fn) const noexcept -> void;
+  // Calls `block_fn(block, first_offset, last_offset)` for the page blocks
+  // under a view, whole blocks of columns with an `AggregateIndex` come as
+  // `totals_fn(totals)` instead. Returns false for detached ranges. Defined
+  // in page.hpp.
+  template <typename BlockFn, typename TotalsFn>
+  auto for_each_block(BlockFn&& block_fn, TotalsFn&& totals_fn) const noexcept
+      -> bool;
 
-  auto div([[maybe_unused]] MytObjectPtr other) const noexcept
-      -> MytObjectPtr override {
-    return std::make_shared<ErrorObject>("Can't div cells range");
-  }
+ private:
+  std::string m_range_str{};
+  const Page* m_page{nullptr};
+  CellPos m_begin{0, 0};
+  CellPos m_end{0, 0};
+  std::vector<MytValue> m_cells_range{};  // detached cells
+};
+
+// Result of an element-wise operation over ranges. Numbers and bools live in
+// a dense lane buffer tagged by `kinds()`, comparisons only write bool lanes.
+// Strings, errors and Nil are the rare `Kind::Other` lanes kept aside.
+class ArrayObject : public MytObject {
+ public:
+  enum class Kind : uint8_t { Int, Float, Bool, Other };
+
+  ArrayObject() = delete;
+  explicit ArrayObject(const std::size_t& size)
+      : m_numbers(size), m_kinds(size, Kind::Other), m_others() {};
+  explicit ArrayObject(const std::vector<MytValue>& values);
+  explicit ArrayObject(const CellRangeObject& range);
+
+  auto to_string() const noexcept -> const std::string override;
+  [[nodiscard]] auto equals(const MytObject& other) const noexcept
+      -> bool override;
 
-  [[nodiscard]] auto get_cells_range() const noexcept
-      -> std::vector<MytObjectPtr> {
-    return m_cells_range;
+  auto add(MytObjectPtr other) const noexcept -> MytObjectPtr override;
+  auto sub(MytObjectPtr other) const noexcept -> MytObjectPtr override;
+  auto mul(MytObjectPtr other) const noexcept -> MytObjectPtr override;
+  auto div(MytObjectPtr other) const noexcept -> MytObjectPtr override;
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return m_kinds.size();
+  }
+  [[nodiscard]] auto numbers() const noexcept -> const std::vector<double>& {
+    return m_numbers;
+  }
+  [[nodiscard]] auto kinds() const noexcept -> const std::vector<Kind>& {
+    return m_kinds;
   }
+  [[nodiscard]] auto get(const std::size_t& idx) const noexcept -> MytValue;
+  auto set(const std::size_t& idx, const MytValue& value) noexcept -> void;
 
  private:
-  std::string m_range_str{};
-  std::vector<MytObjectPtr> m_cells_range{};
+  friend class ElementWise;
+
+  std::vector<double> m_numbers{};  // ints and floats widened, bools as 0/1
+  std::vector<Kind> m_kinds{};
+  std::unordered_map<std::size_t, MytValue> m_others{};
 };
 
 #endif  // MYT_OBJECT_HPP{
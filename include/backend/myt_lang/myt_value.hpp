@@ -0,0 +1,174 @@
+#ifndef MYT_VALUE_HPP
+#define MYT_VALUE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "backend/myt_lang/ast.hpp"
+
+class MytObject;
+
+using MytObjectPtr = std::shared_ptr<MytObject>;
+
+enum class BinaryOp : uint8_t { Add, Sub, Mul, Div, Eq, NotEq, Gt, Ge, Lt, Le };
+
+// 16 bytes tagged value. Ints, floats, bools and Nil live inline and never
+// touch the heap, anything else (strings, errors, identifiers, ranges) stays
+// a `MytObject` counting the values holding it, see `from_object`.
+class MytValue {
+ public:
+  enum class Tag : uint8_t { Nil, Int, Float, Bool, Object };
+
+  MytValue() noexcept = default;
+  MytValue(const MytValue& other) noexcept { copy_from(other); }
+  MytValue(MytValue&& other) noexcept { move_from(std::move(other)); }
+  ~MytValue() { release(); }
+
+  auto operator=(const MytValue& other) noexcept -> MytValue& {
+    if (this != &other) {
+      release();
+      copy_from(other);
+    }
+    return *this;
+  }
+  auto operator=(MytValue&& other) noexcept -> MytValue& {
+    if (this != &other) {
+      release();
+      move_from(std::move(other));
+    }
+    return *this;
+  }
+
+  [[nodiscard]] static auto from_int(const int& value) noexcept -> MytValue {
+    auto result = MytValue{};
+    result.m_tag = Tag::Int;
+    result.m_payload.int_value = value;
+    return result;
+  }
+  [[nodiscard]] static auto from_float(const FloatType& value) noexcept
+      -> MytValue {
+    auto result = MytValue{};
+    result.m_tag = Tag::Float;
+    result.m_payload.float_value = value;
+    return result;
+  }
+  [[nodiscard]] static auto from_bool(const bool& value) noexcept
+      -> MytValue {
+    auto result = MytValue{};
+    result.m_tag = Tag::Bool;
+    result.m_payload.bool_value = value;
+    return result;
+  }
+  // Scalar `ValueObject`s and `NilObject` are unboxed, the rest is shared
+  [[nodiscard]] static auto from_object(const MytObjectPtr& obj) noexcept
+      -> MytValue;
+  [[nodiscard]] static auto error(const std::string& msg) noexcept
+      -> MytValue;
+
+  [[nodiscard]] auto tag() const noexcept -> Tag { return m_tag; }
+  [[nodiscard]] auto is_nil() const noexcept -> bool {
+    return m_tag == Tag::Nil;
+  }
+  [[nodiscard]] auto is_numeric() const noexcept -> bool {
+    return m_tag == Tag::Int || m_tag == Tag::Float;
+  }
+  [[nodiscard]] auto is_error() const noexcept -> bool;
+
+  [[nodiscard]] auto get_int() const noexcept -> int {
+    return m_payload.int_value;
+  }
+  [[nodiscard]] auto get_float() const noexcept -> FloatType {
+    return m_payload.float_value;
+  }
+  [[nodiscard]] auto get_bool() const noexcept -> bool {
+    return m_payload.bool_value;
+  }
+  // Int or float widened to double, 0 for anything else
+  [[nodiscard]] auto get_number() const noexcept -> double {
+    switch (m_tag) {
+      case Tag::Int:
+        return static_cast<double>(m_payload.int_value);
+      case Tag::Float:
+        return static_cast<double>(m_payload.float_value);
+      default:
+        return 0.0;
+    }
+  }
+  // nullptr unless `tag()` is `Tag::Object`
+  [[nodiscard]] auto get_object() const noexcept -> const MytObject* {
+    return (m_tag == Tag::Object) ? m_payload.object : nullptr;
+  }
+
+  // Allocates a new `MytObject` for inline values
+  [[nodiscard]] auto to_object() const noexcept -> MytObjectPtr;
+  [[nodiscard]] auto to_string() const noexcept -> std::string;
+
+  // Same type and value without formatting either side, boxed objects
+  // compare with `MytObject::equals`
+  [[nodiscard]] auto operator==(const MytValue& other) const noexcept -> bool;
+  [[nodiscard]] auto operator!=(const MytValue& other) const noexcept
+      -> bool {
+    return !(*this == other);
+  }
+  // Equal with the same sign, `0` and `-0` print differently. NaN never
+  // equals itself.
+  [[nodiscard]] static auto same_number(const double& lhs,
+                                        const double& rhs) noexcept -> bool;
+
+  // Same results as the `MytObject` operators, without allocating when both
+  // sides are numeric. Ranges and arrays are computed element-wise.
+  [[nodiscard]] static auto add(const MytValue& lhs,
+                                const MytValue& rhs) noexcept -> MytValue;
+  [[nodiscard]] static auto sub(const MytValue& lhs,
+                                const MytValue& rhs) noexcept -> MytValue;
+  [[nodiscard]] static auto mul(const MytValue& lhs,
+                                const MytValue& rhs) noexcept -> MytValue;
+  [[nodiscard]] static auto div(const MytValue& lhs,
+                                const MytValue& rhs) noexcept -> MytValue;
+  // Numbers compare by value, strings and bools compare with their own type.
+  // Other mixed types are only unequal, ordering them is an error.
+  [[nodiscard]] static auto compare(const BinaryOp& op,
+                                    const MytValue& lhs,
+                                    const MytValue& rhs) noexcept -> MytValue;
+  [[nodiscard]] static auto binary(const BinaryOp& op,
+                                   const MytValue& lhs,
+                                   const MytValue& rhs) noexcept -> MytValue;
+
+ private:
+  auto copy_from(const MytValue& other) noexcept -> void {
+    m_tag = other.m_tag;
+    m_payload = other.m_payload;
+    if (m_tag == Tag::Object) {
+      retain_object(m_payload.object);
+    }
+  }
+  auto move_from(MytValue&& other) noexcept -> void {
+    m_tag = other.m_tag;
+    m_payload = other.m_payload;
+    other.m_tag = Tag::Nil;
+  }
+  auto release() noexcept -> void {
+    if (m_tag == Tag::Object) {
+      release_object(m_payload.object);
+    }
+    m_tag = Tag::Nil;
+  }
+  static auto retain_object(const MytObject* object) noexcept -> void;
+  static auto release_object(const MytObject* object) noexcept -> void;
+
+  union Payload {
+    int int_value;
+    FloatType float_value;
+    bool bool_value;
+    const MytObject* object;
+  };
+
+  Payload m_payload{0};
+  Tag m_tag{Tag::Nil};
+};
+
+static_assert(sizeof(MytValue) == 16, "MytValue should stay 16 bytes");
+
+#endif  // !MYT_VALUE_HPP
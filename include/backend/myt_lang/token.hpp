@@ -1,9 +1,11 @@
 #ifndef TOKEN_HPP
 #define TOKEN_HPP
 
+#include <array>
 #include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 
 enum class TokenType : uint8_t {
   Illegal,
@@ -41,19 +43,33 @@ enum class TokenType : uint8_t {
 
 namespace TokenUtils {
 const std::string token_type_to_string(const TokenType& tokenType) noexcept;
-static std::unordered_map<std::string, TokenType> keywordsLookup{
+constexpr std::array<std::pair<std::string_view, TokenType>, 2> keywords{{
     {"true", TokenType::Bool},
     {"false", TokenType::Bool},
-};
+}};
 
 }  // namespace TokenUtils
 
 struct Token {
-  const TokenType type;
-  const std::string literal;
+  TokenType type;
+  std::string literal;
 
   operator std::string() const;
   bool operator==(const Token& rhs) const;
 };
 
+// Non owning token, `literal` views into the tokenized source or into a
+// string literal, so it is only valid as long as the source is
+struct TokenView {
+  TokenType type;
+  std::string_view literal;
+
+  [[nodiscard]] auto to_token() const -> Token {
+    return Token{type, std::string(literal)};
+  }
+  bool operator==(const TokenView& rhs) const {
+    return type == rhs.type && literal == rhs.literal;
+  }
+};
+
 #endif  // !TOKEN_HPP
@@ -0,0 +1,40 @@
+#ifndef VM_HPP
+#define VM_HPP
+
+#include <vector>
+
+#include "backend/myt_lang/builtin_id.hpp"
+#include "backend/myt_lang/bytecode.hpp"
+#include "backend/myt_lang/myt_value.hpp"
+#include "backend/page.hpp"
+
+// Switch dispatched stack machine running `Program`s from `Compiler`.
+// Results match `Evaluator` on the same expression tree. Cell operands are
+// shifted by `offset` for programs shared between cells.
+class Vm {
+ public:
+  Vm() = delete;
+
+  [[nodiscard]] static auto execute(const Program& program,
+                                    const Page& page,
+                                    const CellOffset& offset = {}) noexcept
+      -> MytValue;
+
+ private:
+  using Stack = std::vector<MytValue>;
+
+  [[nodiscard]] static auto load_cell(const CellPos& pos,
+                                      const Page& page) noexcept -> MytValue;
+  [[nodiscard]] static auto neg(const MytValue& value) noexcept -> MytValue;
+  [[nodiscard]] static auto logical_not(const MytValue& value) noexcept
+      -> MytValue;
+  [[nodiscard]] static auto binary(const OpCode& op,
+                                   const MytValue& lhs,
+                                   const MytValue& rhs) noexcept -> MytValue;
+  [[nodiscard]] static auto call_builtin(const BuiltinId& builtin,
+                                         Stack& stack,
+                                         const uint16_t& argc) noexcept
+      -> MytValue;
+};
+
+#endif  // !VM_HPP
@@ -5,18 +5,37 @@
 #include <qtmetamacros.h>
 #include <qurl.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "aggregate_index.hpp"
+#include "cell_block.hpp"
 #include "data_cell.hpp"
 #include "myt_lang/cell_pos.hpp"
 
 using CellMap = std::unordered_map<CellPos, DataCell>;
 
+// Sparse sheet storage, every column is split into `CellBlock`s of
+// `CellBlock::ROWS` rows, blocks are allocated only when they hold a cell.
+// Copies share blocks until either side writes to them.
 class Page {
  public:
-  explicit Page() : m_cells() {}
+  using BlockPtr = std::shared_ptr<CellBlock>;
+  using Column = std::vector<BlockPtr>;
+  using IndexPtr = std::shared_ptr<AggregateIndex>;
+
+  explicit Page() : m_columns(), m_indexes() {}
+  explicit Page(const CellMap& cells) : m_columns(), m_indexes() {
+    for (const auto& [pos, data_cell] : cells) {
+      save_cell(data_cell, pos);
+    }
+  }
 
   [[nodiscard]] auto cell_exists(const CellPos& pos) const noexcept -> bool;
   [[nodiscard]] auto get_cell_raw_content(const CellPos& pos) const noexcept
@@ -24,15 +43,202 @@ class Page {
   [[nodiscard]] auto get_cell_eval_content(const CellPos& pos) const noexcept
       -> std::optional<std::string>;
 
-  [[nodiscard]] auto get_cells() const noexcept -> CellMap { return m_cells; }
+  // Pointer is valid until the next modification of the page
+  [[nodiscard]] auto get_cell(const CellPos& pos) const noexcept
+      -> const DataCell*;
+  [[nodiscard]] auto get_block(const CellLimitType& col,
+                               const std::size_t& block_idx) const noexcept
+      -> const CellBlock*;
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return m_size; }
+
   auto save_cell(const DataCell& data_cell, const CellPos& pos) noexcept
-      -> void {
-    m_cells.insert_or_assign(pos, data_cell);
-  };
+      -> void;
   auto erase_cell(const CellPos& pos) noexcept -> void;
 
+  // Opt-in per column, an indexed column keeps an `AggregateIndex` up to date
+  // on every write so range aggregates skip reading its whole blocks
+  auto set_aggregate_index(const CellLimitType& col,
+                           const bool& enabled) noexcept -> void;
+  [[nodiscard]] auto get_aggregate_index(const CellLimitType& col)
+      const noexcept -> const AggregateIndex*;
+
+  // Calls `fn(pos, data_cell)` for every stored cell
+  template <typename Fn>
+  auto for_each_cell(Fn&& fn) const noexcept -> void {
+    for (const auto& [col, column] : m_columns) {
+      for (std::size_t block_idx{0}; block_idx < column.size(); ++block_idx) {
+        const auto& block = column[block_idx];
+        if (block == nullptr) continue;
+        for (std::size_t offset{0}; offset < CellBlock::ROWS; ++offset) {
+          if (const auto data_cell = block->get(offset)) {
+            fn(CellPos{col, to_row(block_idx, offset)}, *data_cell);
+          }
+        }
+      }
+    }
+  }
+
+  // Calls `fn(pos, data_cell_or_nullptr)` for every position from `begin` to
+  // `end`, column by column, hashing only once per column
+  template <typename Fn>
+  auto visit_range(const CellPos& begin,
+                   const CellPos& end,
+                   Fn&& fn) const noexcept -> void {
+    for (uint32_t col{begin.col}; col <= end.col; ++col) {
+      const auto column_it = m_columns.find(static_cast<CellLimitType>(col));
+      const auto column =
+          (column_it != m_columns.cend()) ? &column_it->second : nullptr;
+      for (uint32_t row{begin.row}; row <= end.row; ++row) {
+        const auto pos = CellPos{static_cast<CellLimitType>(col),
+                                 static_cast<CellLimitType>(row)};
+        const auto block = get_block(column, CellBlock::block_idx(pos.row));
+        fn(pos, block ? block->get(CellBlock::row_offset(pos.row)) : nullptr);
+      }
+    }
+  }
+
+  // Calls `fn(col, block_idx, block, first_offset, last_offset)` for the
+  // allocated blocks under `begin`..`end`, column by column, with the
+  // inclusive row offsets of the block inside the rectangle
+  template <typename Fn>
+  auto visit_blocks(const CellPos& begin,
+                    const CellPos& end,
+                    Fn&& fn) const noexcept -> void {
+    if (begin.row > end.row) return;
+    const auto first_block = CellBlock::block_idx(begin.row);
+    const auto end_block = CellBlock::block_idx(end.row);
+    for (uint32_t col{begin.col}; col <= end.col; ++col) {
+      const auto column_it = m_columns.find(static_cast<CellLimitType>(col));
+      if (column_it == m_columns.cend()) continue;
+      const auto& column = column_it->second;
+      const auto last_block = std::min(end_block + 1, column.size());
+      for (auto block_idx = first_block; block_idx < last_block; ++block_idx) {
+        const auto& block = column[block_idx];
+        if (block == nullptr) continue;
+        const auto first_offset = (block_idx == first_block)
+                                      ? CellBlock::row_offset(begin.row)
+                                      : 0;
+        const auto last_offset = (block_idx == end_block)
+                                     ? CellBlock::row_offset(end.row)
+                                     : CellBlock::ROWS - 1;
+        fn(static_cast<CellLimitType>(col), block_idx, *block, first_offset,
+           last_offset);
+      }
+    }
+  }
+
+  // Like `visit_blocks`, but the blocks of an indexed column lying fully
+  // inside the rows of the rectangle come as one `totals_fn(totals)` call
+  template <typename BlockFn, typename TotalsFn>
+  auto visit_aggregates(const CellPos& begin,
+                        const CellPos& end,
+                        BlockFn&& block_fn,
+                        TotalsFn&& totals_fn) const noexcept -> void {
+    if (begin.row > end.row) return;
+    const auto first_block = CellBlock::block_idx(begin.row);
+    const auto end_block = CellBlock::block_idx(end.row);
+    const auto first_whole =
+        first_block + (CellBlock::row_offset(begin.row) != 0 ? 1 : 0);
+    const auto last_whole_end =
+        end_block +
+        (CellBlock::row_offset(end.row) == CellBlock::ROWS - 1 ? 1 : 0);
+    for (uint32_t col{begin.col}; col <= end.col; ++col) {
+      const auto column = static_cast<CellLimitType>(col);
+      const auto index_it = m_indexes.find(column);
+      if (index_it == m_indexes.cend() || first_whole >= last_whole_end) {
+        visit_blocks(CellPos{column, begin.row}, CellPos{column, end.row},
+                     block_fn);
+        continue;
+      }
+      totals_fn(index_it->second->query(first_whole, last_whole_end - 1));
+      if (first_whole != first_block) {
+        visit_blocks(CellPos{column, begin.row},
+                     CellPos{column, to_row(first_block, CellBlock::ROWS - 1)},
+                     block_fn);
+      }
+      if (last_whole_end <= end_block) {
+        visit_blocks(CellPos{column, to_row(last_whole_end, 0)},
+                     CellPos{column, end.row}, block_fn);
+      }
+    }
+  }
+
+  // Calls `fn(pos, data_cell)` for the stored cells from `begin` to `end`,
+  // column by column, skipping missing columns and unallocated blocks
+  template <typename Fn>
+  auto visit_occupied(const CellPos& begin,
+                      const CellPos& end,
+                      Fn&& fn) const noexcept -> void {
+    visit_blocks(begin, end,
+                 [&fn](const CellLimitType& col, const std::size_t& block_idx,
+                       const CellBlock& block, const std::size_t& first_offset,
+                       const std::size_t& last_offset) {
+                   for (auto offset = first_offset; offset <= last_offset;
+                        ++offset) {
+                     if (const auto data_cell = block.get(offset)) {
+                       fn(CellPos{col, to_row(block_idx, offset)}, *data_cell);
+                     }
+                   }
+                 });
+  }
+
  private:
-  CellMap m_cells;
+  [[nodiscard]] static auto to_row(const std::size_t& block_idx,
+                                   const std::size_t& offset) noexcept
+      -> CellLimitType {
+    return static_cast<CellLimitType>(block_idx * CellBlock::ROWS + offset);
+  }
+  [[nodiscard]] static auto get_block(const Column* column,
+                                      const std::size_t& block_idx) noexcept
+      -> const CellBlock*;
+  [[nodiscard]] auto mutable_block(const CellPos& pos) noexcept -> CellBlock&;
+  // The cell at `pos` changed, `old_number` is its value before
+  auto update_index(const CellPos& pos,
+                    const std::optional<double>& old_number) noexcept -> void;
+
+  std::unordered_map<CellLimitType, Column> m_columns;
+  // Shared between copies like the blocks
+  std::unordered_map<CellLimitType, IndexPtr> m_indexes;
+  std::size_t m_size{0};
 };
 
+template <typename Fn>
+auto CellRangeObject::for_each_occupied(Fn&& fn) const noexcept -> void {
+  if (!is_view()) {
+    for (std::size_t idx{0}; idx < m_cells_range.size(); ++idx) {
+      if (!m_cells_range[idx].is_nil()) {
+        fn(idx, m_cells_range[idx]);
+      }
+    }
+    return;
+  }
+  const auto rows = static_cast<std::size_t>(m_end.row - m_begin.row) + 1;
+  m_page->visit_occupied(
+      m_begin, m_end, [&](const CellPos& pos, const DataCell& data_cell) {
+        const auto& value = data_cell.get_value();
+        if (value.is_nil()) return;
+        const auto col = static_cast<std::size_t>(pos.col - m_begin.col);
+        const auto row = static_cast<std::size_t>(pos.row - m_begin.row);
+        fn(col * rows + row, value);
+      });
+}
+
+template <typename BlockFn, typename TotalsFn>
+auto CellRangeObject::for_each_block(BlockFn&& block_fn,
+                                     TotalsFn&& totals_fn) const noexcept
+    -> bool {
+  if (!is_view()) {
+    return false;
+  }
+  m_page->visit_aggregates(
+      m_begin, m_end,
+      [&block_fn](const CellLimitType&, const std::size_t&,
+                  const CellBlock& block, const std::size_t& first_offset,
+                  const std::size_t& last_offset) {
+        block_fn(block, first_offset, last_offset);
+      },
+      totals_fn);
+  return true;
+}
+
 #endif  // !PAGE_HPP
@@ -0,0 +1,147 @@
+#ifndef RANGE_INDEX_HPP
+#define RANGE_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "myt_lang/cell_pos.hpp"
+
+// Dynamic interval tree over `[lo, hi]` row intervals, a treap keyed by
+// `(lo, id)` where every node keeps the largest `hi` of its subtree.
+class IntervalTreap {
+ public:
+  explicit IntervalTreap() : m_nodes(), m_free() {}
+
+  auto insert(const uint32_t& lo,
+              const uint32_t& hi,
+              const uint32_t& id) noexcept -> void;
+  auto erase(const uint32_t& lo, const uint32_t& id) noexcept -> void;
+  [[nodiscard]] auto empty() const noexcept -> bool { return m_root == NIL; }
+
+  // Calls `fn(id)` for every interval containing `point`
+  template <typename Fn>
+  auto stab(const uint32_t& point, Fn&& fn) const noexcept -> void {
+    stab(m_root, point, fn);
+  }
+
+ private:
+  using NodeIdx = int32_t;
+  static constexpr NodeIdx NIL = -1;
+
+  struct Node {
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t max_hi;
+    uint32_t id;
+    uint32_t priority;
+    NodeIdx left{NIL};
+    NodeIdx right{NIL};
+  };
+
+  template <typename Fn>
+  auto stab(const NodeIdx& idx,
+            const uint32_t& point,
+            Fn& fn) const noexcept -> void {
+    if (idx == NIL) return;
+    const auto& node = m_nodes[static_cast<std::size_t>(idx)];
+    if (node.max_hi < point) return;
+    stab(node.left, point, fn);
+    if (node.lo <= point) {
+      if (point <= node.hi) {
+        fn(node.id);
+      }
+      // Right subtree starts at `lo >= node.lo`, prune it past `point`
+      stab(node.right, point, fn);
+    }
+  }
+
+  [[nodiscard]] auto node(const NodeIdx& idx) noexcept -> Node& {
+    return m_nodes[static_cast<std::size_t>(idx)];
+  }
+  [[nodiscard]] auto is_before(const uint32_t& lo,
+                               const uint32_t& id,
+                               const Node& other) const noexcept -> bool {
+    return (lo == other.lo) ? id < other.id : lo < other.lo;
+  }
+  auto update(const NodeIdx& idx) noexcept -> void;
+  [[nodiscard]] auto rotate_left(const NodeIdx& idx) noexcept -> NodeIdx;
+  [[nodiscard]] auto rotate_right(const NodeIdx& idx) noexcept -> NodeIdx;
+  [[nodiscard]] auto insert(const NodeIdx& root,
+                            const NodeIdx& new_idx) noexcept -> NodeIdx;
+  [[nodiscard]] auto erase(const NodeIdx& root,
+                           const uint32_t& lo,
+                           const uint32_t& id) noexcept -> NodeIdx;
+  [[nodiscard]] auto merge(const NodeIdx& lhs, const NodeIdx& rhs) noexcept
+      -> NodeIdx;
+  [[nodiscard]] auto next_priority() noexcept -> uint32_t;
+
+  std::vector<Node> m_nodes;
+  std::vector<NodeIdx> m_free;
+  NodeIdx m_root{NIL};
+  uint64_t m_seed{0x9E3779B97F4A7C15};
+};
+
+// Rectangular cell ranges referenced by formulas. Columns are split into
+// bands of `BAND_COLS`, every band keeps an `IntervalTreap` over the rows of
+// the rectangles overlapping it, so finding the formulas reading a cell costs
+// a hash lookup plus a logarithmic stab, independent of the ranges' sizes.
+class RangeIndex {
+ public:
+  static constexpr uint32_t BAND_COLS = 64;
+
+  explicit RangeIndex()
+      : m_entries(), m_free_entries(), m_owner_entries(), m_bands() {}
+
+  // `begin` is the top left and `end` the bottom right corner, inclusive
+  auto insert(const CellPos& owner,
+              const CellPos& begin,
+              const CellPos& end) noexcept -> void;
+  auto erase_owner(const CellPos& owner) noexcept -> void;
+  auto clear() noexcept -> void;
+  [[nodiscard]] auto has_owner(const CellPos& owner) const noexcept -> bool {
+    return m_owner_entries.find(owner) != m_owner_entries.cend();
+  }
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return m_entries.size() - m_free_entries.size();
+  }
+
+  // Calls `fn(owner)` for every range containing `pos`, once per range
+  template <typename Fn>
+  auto for_each_owner_at(const CellPos& pos, Fn&& fn) const noexcept -> void {
+    const auto band_it = m_bands.find(pos.col / BAND_COLS);
+    if (band_it == m_bands.cend()) return;
+    band_it->second.stab(pos.row, [&](const uint32_t& entry_idx) {
+      const auto& entry = m_entries[entry_idx];
+      if (entry.begin.col <= pos.col && pos.col <= entry.end.col) {
+        fn(entry.owner);
+      }
+    });
+  }
+
+  // Calls `fn(owner, begin, end)` for every stored range
+  template <typename Fn>
+  auto for_each_range(Fn&& fn) const noexcept -> void {
+    for (const auto& [owner, entries] : m_owner_entries) {
+      for (const auto& entry_idx : entries) {
+        const auto& entry = m_entries[entry_idx];
+        fn(owner, entry.begin, entry.end);
+      }
+    }
+  }
+
+ private:
+  struct Entry {
+    CellPos owner;
+    CellPos begin;
+    CellPos end;
+  };
+
+  std::vector<Entry> m_entries;
+  std::vector<uint32_t> m_free_entries;
+  std::unordered_map<CellPos, std::vector<uint32_t>> m_owner_entries;
+  std::unordered_map<uint32_t, IntervalTreap> m_bands;
+};
+
+#endif  // !RANGE_INDEX_HPP
@@ -1,16 +1,26 @@
 #ifndef STATE_HPP
 #define STATE_HPP
 
+#include <qlist.h>
 #include <qobject.h>
 #include <qtmetamacros.h>
 #include <qurl.h>
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "backend/cell_dependencies_handler.hpp"
 #include "backend/myt_lang/cell_pos.hpp"
 #include "backend/page.hpp"
+#include "backend/thread_pool.hpp"
 
 class State : public QObject {
   Q_OBJECT
@@ -21,6 +31,7 @@ class State : public QObject {
 
  public:
   explicit State(QObject* parent = nullptr);
+  ~State() override;
 
   int editingCol() const { return m_editingCol; }
   int editingRow() const { return m_editingRow; }
@@ -34,8 +45,30 @@ class State : public QObject {
                              const CellLimitType& col,
                              const CellLimitType& row) noexcept;
   Q_INVOKABLE void log_cells() const noexcept;
+  // Grid area on screen, `cols` by `rows` cells from `col`, `row` counting
+  // the header row and column. Background recalculations evaluate its dirty
+  // cells and their precedents first, again every time it moves.
+  Q_INVOKABLE void set_viewport(const CellLimitType& col,
+                                const CellLimitType& row,
+                                const CellLimitType& cols,
+                                const CellLimitType& rows) noexcept;
 
   auto flush_dependencies() noexcept -> void;
+  // Workers evaluating wide dependency levels, 0 or 1 recalculates
+  // sequentially on the calling thread. Waits for a running background
+  // recalculation first.
+  auto set_recalc_workers(const std::size_t& n_workers) noexcept -> void;
+  // Recalculates dependents of an edit on a background thread against a
+  // snapshot of the page, results come back in `requestCellsUpdate` batches.
+  // Off by default, edits then recalculate before `eval_save` returns.
+  auto set_async_recalc(const bool& enabled) noexcept -> void;
+  // Answers range aggregates over `col` from an `AggregateIndex` kept up to
+  // date on every write to the column, worth it for long ranges read by
+  // many formulas. Off by default.
+  auto set_aggregate_index(const CellLimitType& col,
+                           const bool& enabled) noexcept -> void;
+  // Blocks until the running recalculation finished and applies its results
+  auto wait_for_recalc() noexcept -> void;
   [[nodiscard]] auto get_dependencies() const noexcept
       -> const DependenciesHandler::Dependencies;
   [[nodiscard]] auto get_dependencies_uses() const noexcept
@@ -46,7 +79,8 @@ class State : public QObject {
   void setEditingRow(int row);
 
  signals:
-  void requestCellUpdate(int col, int row);
+  // Flattened `col, row` pairs of recalculated cells
+  void requestCellsUpdate(const QList<int>& positions);
   void editingColChanged();
   void editingRowChanged();
 
@@ -62,7 +96,87 @@ class State : public QObject {
   template <class Container>
   [[nodiscard]] static auto build_cell_pos_str(const Container& c)
       -> std::string;
-  auto reeval_affected(const CellPos& pos) noexcept -> void;
+  using CellResults = std::vector<std::pair<CellPos, DataCell>>;
+  struct RecalcBatch {
+    std::uint64_t generation;
+    CellResults cells;
+    bool is_last;
+  };
+
+  // Inclusive corners of the visible cells
+  using Viewport = std::pair<CellPos, CellPos>;
+  // Progress of a background recalculation
+  struct RecalcRun {
+    const DependenciesHandler::RecalcPlan& plan;
+    DependenciesHandler::CellPosSet outdated;
+    // Levels before `level_idx` are done, visible cells may be done already
+    std::size_t level_idx;
+    DependenciesHandler::CellPosSet visible_done;
+    // Built for the first viewport, `plan.affected` reversed
+    std::unordered_map<CellPos, std::size_t> level_of;
+    std::unordered_map<CellPos, std::vector<CellPos>> precedents;
+  };
+
+  auto recalc(const DependenciesHandler::CellPosSet& seeds) noexcept -> void;
+  auto reeval_affected(const DependenciesHandler::CellPosSet& seeds) noexcept
+      -> void;
+  auto start_recalc(const DependenciesHandler::CellPosSet& seeds) noexcept
+      -> void;
+  auto stop_recalc() noexcept -> void;
+  auto run_recalc(const std::uint64_t& generation,
+                  const DependenciesHandler::RecalcPlan& plan,
+                  const DependenciesHandler::CellPosSet& seeds,
+                  Page& page) noexcept -> void;
+  // Evaluates the outdated `cells` of one level and posts the changed ones,
+  // false once `generation` is superseded
+  [[nodiscard]] auto recalc_cells(RecalcRun& run,
+                                  const std::vector<CellPos>& cells,
+                                  Page& page,
+                                  const std::uint64_t& generation) noexcept
+      -> bool;
+  [[nodiscard]] auto recalc_visible(RecalcRun& run,
+                                    Page& page,
+                                    const std::uint64_t& generation) noexcept
+      -> bool;
+  [[nodiscard]] auto get_viewport() const noexcept -> std::optional<Viewport>;
+  auto post_recalc_results(RecalcBatch&& batch) noexcept -> void;
+  auto apply_recalc_results() noexcept -> void;
+  [[nodiscard]] auto is_stale(const std::uint64_t& generation) const noexcept
+      -> bool {
+    return m_recalc_generation.load() != generation;
+  }
+  // Evaluates `cells[begin, end)` against `page`, the cells must not read
+  // each other. Stops early once `generation` is superseded.
+  [[nodiscard]] auto evaluate_cells(const Page& page,
+                                    const std::vector<CellPos>& cells,
+                                    const std::size_t& begin,
+                                    const std::size_t& end,
+                                    const std::uint64_t& generation)
+      const noexcept -> std::vector<std::optional<DataCell>>;
+  [[nodiscard]] static auto compute_cell(const Page& page,
+                                         const CellPos& pos) noexcept
+      -> std::optional<DataCell>;
+
+  // Early cutoff, only cells reading a cell whose value changed during the
+  // recalculation are evaluated again, starting from the cells reading the
+  // seeds. `outdated` holds the cells waiting to be evaluated.
+  static auto mark_outdated(const DependenciesHandler::RecalcPlan& plan,
+                            const CellPos& changed_pos,
+                            DependenciesHandler::CellPosSet& outdated) noexcept
+      -> void;
+  [[nodiscard]] static auto take_outdated(
+      const std::vector<CellPos>& level,
+      DependenciesHandler::CellPosSet& outdated) noexcept
+      -> std::vector<CellPos>;
+  [[nodiscard]] static auto value_changed(const Page& page,
+                                          const CellPos& pos,
+                                          const MytValue& value) noexcept
+      -> bool;
+
+  // Narrower levels are cheaper to evaluate than to hand out to workers
+  static constexpr std::size_t PARALLEL_LEVEL_MIN = 64;
+  // Cells per result batch sent back from the recalculation thread
+  static constexpr std::size_t RECALC_BATCH_CELLS = 4096;
 
   int m_editingCol = -1;
   int m_editingRow = -1;
@@ -70,6 +184,23 @@ class State : public QObject {
   std::size_t m_current_page_idx{};
   std::vector<Page> m_pages;
   DependenciesHandler m_dependencies_handler;
+  std::unique_ptr<ThreadPool> m_thread_pool;
+
+  bool m_async_recalc{false};
+  std::thread m_recalc_thread;
+  // Bumped by every new recalculation, older ones notice and give up
+  std::atomic<std::uint64_t> m_recalc_generation{0};
+  // Seeds, and cells already updated by the running recalculation, whose
+  // dependents were not fully recalculated yet. A superseding recalculation
+  // picks them up again.
+  DependenciesHandler::CellPosSet m_pending_seeds;
+  std::mutex m_recalc_results_mutex;
+  std::vector<RecalcBatch> m_recalc_results;
+
+  mutable std::mutex m_viewport_mutex;
+  std::optional<Viewport> m_viewport;
+  // Bumped by every `set_viewport`, the recalculation thread reprioritizes
+  std::atomic<std::uint64_t> m_viewport_version{0};
 };
 
 #endif  // !STATE_HPP
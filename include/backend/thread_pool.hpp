@@ -0,0 +1,61 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed size work stealing pool. Every worker owns a task deque, takes its
+// newest task first and steals the oldest task of another worker once its
+// own deque runs dry.
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+  using RangeFn = std::function<void(std::size_t, std::size_t)>;
+
+  // Chunks handed out per worker in `parallel_for`, extra ones keep workers
+  // busy through stealing when some chunks run slower than others
+  static constexpr std::size_t CHUNKS_PER_WORKER = 4;
+
+  ThreadPool() = delete;
+  explicit ThreadPool(const std::size_t& n_workers);
+  ThreadPool(const ThreadPool&) = delete;
+  auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+  ~ThreadPool();
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return m_workers.size();
+  }
+
+  // Calls `fn(begin, end)` over chunks of `[0, n)`, the calling thread
+  // runs chunks too and returns once all of them are done
+  auto parallel_for(const std::size_t& n, const RangeFn& fn) noexcept -> void;
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  auto submit(const std::size_t& worker_idx, Task&& task) noexcept -> void;
+  [[nodiscard]] auto try_pop(const std::size_t& worker_idx,
+                             Task& task) noexcept -> bool;
+  [[nodiscard]] auto try_steal(const std::size_t& thief_idx,
+                               Task& task) noexcept -> bool;
+  auto worker_loop(const std::size_t& worker_idx) noexcept -> void;
+
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_workers;
+  std::mutex m_wake_mutex;
+  std::condition_variable m_wake;
+  std::atomic<std::size_t> m_pending{0};  // queued, not yet taken tasks
+  bool m_stop{false};
+};
+
+#endif  // !THREAD_POOL_HPP
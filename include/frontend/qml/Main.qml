@@ -23,6 +23,12 @@ ApplicationWindow {
 
     model: colCount * rowCount
 
+    onColCountChanged: updateViewport()
+    onRowCountChanged: updateViewport()
+    onColOffsetChanged: updateViewport()
+    onRowOffsetChanged: updateViewport()
+    Component.onCompleted: updateViewport()
+
     function moveCells(c, r, dc, dr) {
       var x =  c + dc
       var y = r + dr
@@ -43,6 +49,10 @@ ApplicationWindow {
       updateVisibleCells()
     }
 
+    function updateViewport() {
+      windowState.set_viewport(colOffset, rowOffset, colCount, rowCount)
+    }
+
     function updateVisibleCells() {
       for (let i = 0; i < gridView.count; ++i) {
         const item = gridView.itemAtIndex(i)
@@ -78,11 +88,15 @@ ApplicationWindow {
 
   Connections {
     target: windowState
-    function onRequestCellUpdate(col, row) {
+    function onRequestCellsUpdate(positions) {
+      const updated = new Set()
+      for (let i = 0; i + 1 < positions.length; i += 2) {
+        updated.add(positions[i] + ":" + positions[i + 1])
+      }
       for (let i = 0; i < gridView.count; ++i) {
         const item = gridView.itemAtIndex(i)
-        if (item && item.col === col && item.row === row) {
-          item.label = windowState.get_content_by_pos(col, row)
+        if (item && updated.has(item.col + ":" + item.row)) {
+          item.label = windowState.get_content_by_pos(item.col, item.row)
         }
       }
     }
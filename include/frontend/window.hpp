@@ -7,6 +7,7 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <limits>
+#include <thread>
 
 #include "backend/myt_lang/cell_pos.hpp"
 #include "backend/state.hpp"
@@ -27,6 +28,9 @@ class Window {
         },
         Qt::QueuedConnection);
 
+    m_state.set_recalc_workers(std::thread::hardware_concurrency());
+    m_state.set_async_recalc(true);
+
     m_engine.rootContext()->setContextProperty("windowUtils", &m_wu);
     m_engine.rootContext()->setContextProperty("windowState", &m_state);
 
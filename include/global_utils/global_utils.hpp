@@ -1,6 +1,7 @@
 #ifndef GLOBAL_UTILS_HPP
 #define GLOBAL_UTILS_HPP
 
+#include <cstddef>
 #include <string>
 #include <type_traits>
 #include "backend/myt_lang/cell_pos.hpp"
@@ -12,23 +13,42 @@ class GlobalUtils {
             typename = typename std::enable_if_t<std::is_unsigned_v<T>>>
   [[nodiscard]] static auto col_idx_to_letter_str(const T& n) noexcept
       -> const std::string {
-    std::string acc = "";
-    for (T i = n; i > 0; i /= 26) {
-      i -= 1;
-      acc = (char)((i % 26) + 'A') + acc;
+    char buffer[MAX_LETTERS<T>]{};
+    return std::string(buffer, col_idx_to_letters(n, buffer));
+  }
+
+  // Writes the letters of column `n` into `out`, at most `MAX_LETTERS<T>`
+  // chars, and returns how many were written
+  template <typename T,
+            typename = typename std::enable_if_t<std::is_unsigned_v<T>>>
+  static auto col_idx_to_letters(const T& n, char* out) noexcept
+      -> std::size_t {
+    std::size_t len{0};
+    for (T i = n; i > 0; i = static_cast<T>((i - 1) / 26)) {
+      len++;
+    }
+    auto idx = len;
+    for (T i = n; i > 0; i = static_cast<T>((i - 1) / 26)) {
+      out[--idx] = static_cast<char>((i - 1) % 26 + 'A');
     }
-    return acc;
+    return len;
   }
 
   template <typename T,
             typename = typename std::enable_if_t<std::is_integral_v<T>>>
   [[nodiscard]] static auto is_in_cell_range(const T& idx) noexcept -> bool {
-    return idx > 0 && static_cast<CellLimitType>(idx) < CELL_MAX_LIMIT;
+    // Compared in the wide type, narrowing first would wrap large indexes
+    return idx > 0 && static_cast<unsigned long long>(idx) < CELL_MAX_LIMIT;
   }
 
   // CONSTS
+  // 26^2 > 2^8, so two letters per byte of the index are always enough
+  template <typename T>
+  static constexpr std::size_t MAX_LETTERS = sizeof(T) * 2;
   static const CellLimitType CELL_MAX_LIMIT =
       std::numeric_limits<CellLimitType>::max();
+  // Largest column and row index, `CELL_MAX_LIMIT` itself is out of range
+  static const CellLimitType CELL_MAX_IDX = CELL_MAX_LIMIT - 1;
 };
 
 #endif  // !GLOBAL_UTILS_HPP
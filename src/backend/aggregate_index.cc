@@ -0,0 +1,93 @@
+#include "../../include/backend/aggregate_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+auto AggregateIndex::Totals::merge(const Totals& other) noexcept -> void {
+  sum.add(other.sum.sum);
+  sum.compensation += other.sum.compensation;
+  product *= other.product;
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+  count += other.count;
+  has_floats |= other.has_floats;
+}
+
+auto AggregateIndex::update(const std::size_t& block_idx,
+                            const CellBlock* block) noexcept -> void {
+  auto leaf = Totals{};
+  if (block != nullptr) {
+    const auto& numeric = block->numeric();
+    const auto& numbers = block->numbers();
+    for (std::size_t offset{0}; offset < CellBlock::ROWS; ++offset) {
+      if (!numeric.test(offset)) continue;
+      leaf.sum.add(numbers[offset]);
+      leaf.product *= numbers[offset];
+      leaf.min = std::min(leaf.min, numbers[offset]);
+      leaf.max = std::max(leaf.max, numbers[offset]);
+    }
+    leaf.count = numeric.count();
+    leaf.has_floats = block->floats().any();
+  }
+
+  m_nodes[LEAVES + block_idx] = leaf;
+  update_path(LEAVES + block_idx);
+}
+
+auto AggregateIndex::update_cell(
+    const std::size_t& block_idx,
+    const CellBlock* block,
+    const std::optional<double>& old_number,
+    const std::optional<double>& new_number) noexcept -> void {
+  auto& leaf = m_nodes[LEAVES + block_idx];
+  if (old_number) {
+    const auto old = *old_number;
+    const auto lost_min =
+        old == leaf.min && (!new_number.has_value() || *new_number > old);
+    const auto lost_max =
+        old == leaf.max && (!new_number.has_value() || *new_number < old);
+    // Zeros and overflows can't be divided or subtracted out again
+    if (lost_min || lost_max || old == 0.0 || !std::isfinite(old) ||
+        !std::isfinite(leaf.sum.sum) || !std::isfinite(leaf.product)) {
+      update(block_idx, block);
+      return;
+    }
+    leaf.sum.add(-old);
+    leaf.product /= old;
+    leaf.count--;
+  }
+  if (new_number) {
+    const auto number = *new_number;
+    leaf.sum.add(number);
+    leaf.product *= number;
+    leaf.min = std::min(leaf.min, number);
+    leaf.max = std::max(leaf.max, number);
+    leaf.count++;
+  }
+  leaf.has_floats = block != nullptr && block->floats().any();
+  update_path(LEAVES + block_idx);
+}
+
+auto AggregateIndex::update_path(std::size_t node) noexcept -> void {
+  for (node /= 2; node > 0; node /= 2) {
+    m_nodes[node] = m_nodes[2 * node];
+    m_nodes[node].merge(m_nodes[2 * node + 1]);
+  }
+}
+
+auto AggregateIndex::query(const std::size_t& first_block,
+                           const std::size_t& last_block) const noexcept
+    -> Totals {
+  auto totals = Totals{};
+  auto lo = LEAVES + first_block;
+  auto hi = LEAVES + last_block + 1;
+  for (; lo < hi; lo /= 2, hi /= 2) {
+    if (lo % 2 == 1) {
+      totals.merge(m_nodes[lo++]);
+    }
+    if (hi % 2 == 1) {
+      totals.merge(m_nodes[--hi]);
+    }
+  }
+  return totals;
+}
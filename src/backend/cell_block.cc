@@ -0,0 +1,53 @@
+#include "../../include/backend/cell_block.hpp"
+
+#include <memory>
+
+#include "backend/myt_lang/myt_value.hpp"
+
+auto CellBlock::get(const std::size_t& offset) const noexcept
+    -> const DataCell* {
+  if (!m_occupied.test(offset)) return nullptr;
+  return &m_cells[m_slots[offset]];
+}
+
+auto CellBlock::set(const std::size_t& offset,
+                    const DataCell& data_cell) noexcept -> void {
+  if (m_occupied.test(offset)) {
+    m_cells[m_slots[offset]] = data_cell;
+  } else {
+    m_slots[offset] = static_cast<uint16_t>(m_cells.size());
+    m_cells.push_back(data_cell);
+    m_slot_rows.push_back(static_cast<uint16_t>(offset));
+    m_occupied.set(offset);
+  }
+  update_numeric(offset, data_cell);
+}
+
+auto CellBlock::erase(const std::size_t& offset) noexcept -> bool {
+  if (!m_occupied.test(offset)) return false;
+
+  // Swap with the last stored cell to keep `m_cells` dense
+  const auto slot = m_slots[offset];
+  const auto last_slot = m_cells.size() - 1;
+  if (slot != last_slot) {
+    m_cells[slot] = std::move(m_cells[last_slot]);
+    m_slot_rows[slot] = m_slot_rows[last_slot];
+    m_slots[m_slot_rows[slot]] = slot;
+  }
+  m_cells.pop_back();
+  m_slot_rows.pop_back();
+
+  m_occupied.reset(offset);
+  m_numeric.reset(offset);
+  m_floats.reset(offset);
+  m_numbers[offset] = 0.0;
+  return true;
+}
+
+auto CellBlock::update_numeric(const std::size_t& offset,
+                               const DataCell& data_cell) noexcept -> void {
+  const auto& value = data_cell.get_value();
+  m_numbers[offset] = value.get_number();
+  m_numeric.set(offset, value.is_numeric());
+  m_floats.set(offset, value.tag() == MytValue::Tag::Float);
+}
@@ -1,6 +1,7 @@
 #include "../../include/backend/cell_dependencies_handler.hpp"
 
 #include <cassert>
+#include <utility>
 
 #include "backend/myt_lang/ast.hpp"
 #include "backend/myt_lang/cell_pos.hpp"
@@ -9,39 +10,170 @@
 
 auto DependenciesHandler::update_dependencies(
     const CellPos& affected_pos,
-    const ParsingResult& parsing_result) noexcept -> void {
+    const ParsingResult& parsing_result,
+    const CellOffset& offset) noexcept -> void {
   clear_dependencies_pos(affected_pos);
   if (std::holds_alternative<ParsingError>(parsing_result)) {
     return;
   }
   const auto& expr = std::get<ExpressionSharedPtr>(parsing_result);
-  traverse_expression(affected_pos, *expr);
+  traverse_expression(affected_pos, *expr, offset);
 }
 
 auto DependenciesHandler::flush_dependencies() noexcept -> void {
   m_dependencies.clear();
   m_dependencies_uses.clear();
+  m_range_index.clear();
 }
 
 auto DependenciesHandler::get_dependencies() const noexcept
     -> const Dependencies {
-  return m_dependencies;
+  auto dependencies = m_dependencies;
+  m_range_index.for_each_range(
+      [&](const CellPos& owner, const CellPos& begin, const CellPos& end) {
+        for (auto col{begin.col}; col <= end.col; ++col) {
+          for (auto row{begin.row}; row <= end.row; ++row) {
+            dependencies[CellPos{col, row}].insert(owner);
+          }
+        }
+      });
+  return dependencies;
 };
 
 auto DependenciesHandler::get_dependencies_uses() const noexcept
     -> const Dependencies {
-  return m_dependencies_uses;
+  auto dependencies_uses = m_dependencies_uses;
+  m_range_index.for_each_range(
+      [&](const CellPos& owner, const CellPos& begin, const CellPos& end) {
+        auto& used = dependencies_uses[owner];
+        for (auto col{begin.col}; col <= end.col; ++col) {
+          for (auto row{begin.row}; row <= end.row; ++row) {
+            used.insert(CellPos{col, row});
+          }
+        }
+      });
+  return dependencies_uses;
 };
 
 auto DependenciesHandler::get_affected_positions(const CellPos& pos)
     const noexcept -> const std::optional<std::unordered_set<CellPos>> {
-  if (!is_in_dependencies(pos, m_dependencies))
+  CellPosSet affected{};
+  for_each_affected(pos, [&affected](const CellPos& affected_pos) {
+    affected.insert(affected_pos);
+  });
+  if (affected.empty())
     return std::nullopt;
-  return m_dependencies.at(pos);
+  return affected;
+}
+
+auto DependenciesHandler::get_recalc_order(const CellPosSet& seeds)
+    const noexcept -> std::vector<CellPos> {
+  std::vector<CellPos> order{};
+  for (auto& level : get_recalc_levels(seeds)) {
+    order.insert(order.end(), level.cbegin(), level.cend());
+  }
+  return order;
+}
+
+auto DependenciesHandler::get_recalc_levels(const CellPosSet& seeds)
+    const noexcept -> std::vector<std::vector<CellPos>> {
+  const auto dirty = collect_dirty(seeds);
+
+  std::unordered_map<CellPos, std::size_t> in_degrees{};
+  in_degrees.reserve(dirty.size());
+  for (const auto& pos : dirty) {
+    in_degrees.try_emplace(pos, 0);
+    for_each_affected(pos, [&](const CellPos& affected_pos) {
+      if (dirty.find(affected_pos) != dirty.cend()) {
+        in_degrees[affected_pos]++;
+      }
+    });
+  }
+
+  std::vector<CellPos> level{};
+  for (const auto& [pos, in_degree] : in_degrees) {
+    if (in_degree == 0) {
+      level.push_back(pos);
+    }
+  }
+  // Kahn's algorithm one frontier at a time, a cell lands in the level after
+  // its last dirty precedent. Cells left on a cycle never reach zero
+  // in-degree and are skipped, cycles are filtered out before recalculation
+  // anyway.
+  std::vector<std::vector<CellPos>> levels{};
+  while (!level.empty()) {
+    std::vector<CellPos> next_level{};
+    for (const auto& pos : level) {
+      for_each_affected(pos, [&](const CellPos& affected_pos) {
+        const auto in_degree_it = in_degrees.find(affected_pos);
+        if (in_degree_it == in_degrees.end()) {
+          return;
+        }
+        if (--in_degree_it->second == 0) {
+          next_level.push_back(affected_pos);
+        }
+      });
+    }
+    levels.push_back(std::move(level));
+    level = std::move(next_level);
+  }
+  return levels;
+}
+
+auto DependenciesHandler::get_recalc_plan(const CellPosSet& seeds)
+    const noexcept -> RecalcPlan {
+  auto plan = RecalcPlan{get_recalc_levels(seeds), {}};
+  for (const auto& level : plan.levels) {
+    for (const auto& pos : level) {
+      plan.affected.try_emplace(pos);
+    }
+  }
+  const auto collect = [this, &plan](const CellPos& pos) {
+    std::vector<CellPos> affected{};
+    for_each_affected(pos, [&](const CellPos& affected_pos) {
+      if (plan.affected.find(affected_pos) != plan.affected.cend()) {
+        affected.push_back(affected_pos);
+      }
+    });
+    return affected;
+  };
+  for (const auto& level : plan.levels) {
+    for (const auto& pos : level) {
+      plan.affected[pos] = collect(pos);
+    }
+  }
+  // Seeds outside the dirty cells must not be collected as dirty themselves
+  std::vector<std::pair<CellPos, std::vector<CellPos>>> seeds_affected{};
+  for (const auto& seed : seeds) {
+    seeds_affected.emplace_back(seed, collect(seed));
+  }
+  for (auto& [seed, affected] : seeds_affected) {
+    plan.affected[seed] = std::move(affected);
+  }
+  return plan;
+}
+
+auto DependenciesHandler::collect_dirty(const CellPosSet& seeds) const noexcept
+    -> CellPosSet {
+  CellPosSet dirty{};
+  std::vector<CellPos> stack{seeds.cbegin(), seeds.cend()};
+  while (!stack.empty()) {
+    const auto pos = stack.back();
+    stack.pop_back();
+    // A seed reading another seed is dirty as well, it may have been
+    // evaluated before that seed's dependents settled
+    for_each_affected(pos, [&](const CellPos& affected_pos) {
+      if (dirty.insert(affected_pos).second) {
+        stack.push_back(affected_pos);
+      }
+    });
+  }
+  return dirty;
 }
 
 auto DependenciesHandler::clear_dependencies_pos(const CellPos& pos) noexcept
     -> void {
+  m_range_index.erase_owner(pos);
   if (!is_in_dependencies(pos, m_dependencies_uses)) {
     return;
   }
@@ -57,36 +189,51 @@ auto DependenciesHandler::clear_dependencies_pos(const CellPos& pos) noexcept
   m_dependencies_uses.erase(pos);
 }
 
-auto DependenciesHandler::traverse_expression(const CellPos& affected_pos,
-                                              const Expression& expr) noexcept
-    -> void {
-  if (auto expr_cell_range = dynamic_cast<const ExpressionCellRange*>(&expr)) {
-    const auto cell_range = expr_cell_range->generate_range();
-    for (const auto& pos : cell_range) {
-      append_dependency(affected_pos, pos, m_dependencies);
-      append_dependency(pos, affected_pos, m_dependencies_uses);
-    }
-  } else if (auto infix = dynamic_cast<const ExpressionInfix*>(&expr)) {
-    const auto& lhs = infix->get_lhs_expression();
-    const auto& rhs = infix->get_rhs_expression();
-    traverse_expression(affected_pos, lhs);
-    traverse_expression(affected_pos, rhs);
-  } else if (auto prefix = dynamic_cast<const ExpressionPrefix*>(&expr)) {
-    const auto& rhs = prefix->get_expression();
-    traverse_expression(affected_pos, rhs);
-  } else if (auto cell = dynamic_cast<const ExpressionCell*>(&expr)) {
-    const auto cell_token = cell->get_cell_token();
-    const auto used_pos = CellPos{cell_token.literal};
-    if (used_pos == affected_pos) {
-      return;
-    }
-    append_dependency(affected_pos, used_pos, m_dependencies);
-    append_dependency(used_pos, affected_pos, m_dependencies_uses);
-  } else if (auto call = dynamic_cast<const ExpressionFnCall*>(&expr)) {
-    for (const auto& arg : call->get_arguments()) {
-      traverse_expression(affected_pos, *arg);
-    }
-  }
+auto DependenciesHandler::traverse_expression(
+    const CellPos& affected_pos,
+    const Expression& expr,
+    const CellOffset& offset) noexcept -> void {
+  AstUtils::visit(
+      expr,
+      AstUtils::Overloaded{
+          [&](const ExpressionCellRange& expr_cell_range) {
+            const auto bounds = expr_cell_range.get_range_bounds();
+            if (!bounds) {
+              return;
+            }
+            // Same cells as `generate_range()`, empty for reversed columns
+            const auto begin = offset.apply(std::get<0>(*bounds));
+            const auto end = offset.apply(std::get<1>(*bounds));
+            if (begin.col <= end.col) {
+              m_range_index.insert(affected_pos, begin, end);
+            }
+          },
+          [&](const ExpressionInfix& infix) {
+            traverse_expression(affected_pos, infix.get_lhs_expression(),
+                                offset);
+            traverse_expression(affected_pos, infix.get_rhs_expression(),
+                                offset);
+          },
+          [&](const ExpressionPrefix& prefix) {
+            traverse_expression(affected_pos, prefix.get_expression(),
+                                offset);
+          },
+          [&](const ExpressionCell& cell) {
+            const auto used_pos = offset.apply(cell.get_pos());
+            if (used_pos == affected_pos) {
+              return;
+            }
+            append_dependency(affected_pos, used_pos, m_dependencies);
+            append_dependency(used_pos, affected_pos, m_dependencies_uses);
+          },
+          [&](const ExpressionFnCall& call) {
+            for (const auto& arg : call.get_arguments()) {
+              traverse_expression(affected_pos, *arg, offset);
+            }
+          },
+          // Literals and identifiers read no cells
+          [](const auto&) {},
+      });
 }
 
 auto DependenciesHandler::append_dependency(const CellPos& value_pos,
@@ -101,24 +248,60 @@ auto DependenciesHandler::append_dependency(const CellPos& value_pos,
   deps.insert({key_pos, {value_pos}});
 }
 
+auto DependenciesHandler::has_precedents(const CellPos& pos) const noexcept
+    -> bool {
+  return is_in_dependencies(pos, m_dependencies_uses) ||
+         m_range_index.has_owner(pos);
+}
+
 auto DependenciesHandler::is_in_dependencies(const CellPos& key_pos,
                                              const Dependencies& deps) noexcept
     -> bool {
   return deps.find(key_pos) != deps.cend();
 }
 
-auto DependenciesHandler::catch_circling_cells_DFS() const noexcept
-    -> std::unordered_set<CellPos> {
-  std::unordered_map<CellPos, VisitState> visit_states;
-  std::unordered_set<CellPos> cycled;
+auto DependenciesHandler::find_cycle_through(const CellPos& pos)
+    const noexcept -> CellPosSet {
+  CellPosSet cycled{};
+  if (!has_precedents(pos)) {
+    return cycled;
+  }
 
-  for (const auto& [node, _] : m_dependencies) {
-    if (visit_states[node] == VisitState::Unvisited) {
-      std::vector<CellPos> path_stack;
-      dfs_visit(node, visit_states, cycled, path_stack);
-    }
+  // Forward search over the cells affected by `pos`, the same cells
+  // recalculation visits, keeping the reversed edges
+  std::unordered_map<CellPos, std::vector<CellPos>> affected_by{};
+  CellPosSet visited{pos};
+  std::vector<CellPos> stack{pos};
+  while (!stack.empty()) {
+    const auto current = stack.back();
+    stack.pop_back();
+    for_each_affected(current, [&](const CellPos& affected_pos) {
+      affected_by[affected_pos].push_back(current);
+      if (visited.insert(affected_pos).second) {
+        stack.push_back(affected_pos);
+      }
+    });
+  }
+  if (affected_by.find(pos) == affected_by.cend()) {
+    return cycled;
   }
 
+  // Cells reaching back to `pos` are on a cycle through it
+  cycled.insert(pos);
+  stack.push_back(pos);
+  while (!stack.empty()) {
+    const auto current = stack.back();
+    stack.pop_back();
+    const auto it = affected_by.find(current);
+    if (it == affected_by.cend()) {
+      continue;
+    }
+    for (const auto& used_pos : it->second) {
+      if (cycled.insert(used_pos).second) {
+        stack.push_back(used_pos);
+      }
+    }
+  }
   return cycled;
 }
 
@@ -128,30 +311,3 @@ auto DependenciesHandler::filter_cyclic_dependencies(
     clear_dependencies_pos(pos);
   }
 }
-
-auto DependenciesHandler::dfs_visit(
-    const CellPos& node,
-    std::unordered_map<CellPos, VisitState>& visit_states,
-    std::unordered_set<CellPos>& cycled,
-    std::vector<CellPos>& path_stack) const noexcept -> void {
-  visit_states[node] = VisitState::Visiting;
-  path_stack.push_back(node);
-
-  if (auto it = m_dependencies.find(node); it != m_dependencies.end()) {
-    for (const CellPos& neighbor : it->second) {
-      if (visit_states[neighbor] == VisitState::Visiting) {
-        auto it = std::find(path_stack.begin(), path_stack.end(), neighbor);
-        if (it != path_stack.end()) {
-          for (; it != path_stack.end(); ++it) {
-            cycled.insert(*it);
-          }
-        }
-      } else if (visit_states[neighbor] == VisitState::Unvisited) {
-        dfs_visit(neighbor, visit_states, cycled, path_stack);
-      }
-    }
-  }
-
-  path_stack.pop_back();
-  visit_states[node] = VisitState::Visited;
-}
@@ -1,17 +1,32 @@
 #include "../../include/backend/data_cell.hpp"
 
-auto DataCell::get_raw_content() const noexcept -> std::string {
+auto DataCell::get_raw_content() const noexcept -> const std::string& {
   return m_raw_content;
 }
 
 auto DataCell::set_raw_content(const std::string& value) noexcept -> void {
+  if (value != m_raw_content) {
+    m_formula.reset();
+  }
   m_raw_content = value;
 }
 
 auto DataCell::get_evaluated_content() const noexcept -> const MytObjectPtr {
+  return m_evaluated_content.to_object();
+}
+
+auto DataCell::get_value() const noexcept -> const MytValue& {
   return m_evaluated_content;
 }
 
 auto DataCell::set_eval_content(MytObjectPtr&& value) noexcept -> void {
+  m_evaluated_content = MytValue::from_object(value);
+}
+
+auto DataCell::set_eval_content(MytValue&& value) noexcept -> void {
   m_evaluated_content = std::move(value);
 }
+
+auto DataCell::get_formula() const noexcept -> const FormulaPtr& {
+  return m_formula;
+}
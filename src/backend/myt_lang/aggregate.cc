@@ -0,0 +1,396 @@
+#include "../../../include/backend/myt_lang/aggregate.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+#include "backend/aggregate_index.hpp"
+#include "backend/cell_block.hpp"
+#include "backend/myt_lang/myt_object.hpp"
+#include "backend/page.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MYT_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using Op = Aggregate::Op;
+using Isa = Aggregate::Isa;
+
+struct Kernels {
+  void (*sum)(const double*, std::size_t, CompensatedSum&) noexcept;
+  double (*min)(const double*, std::size_t, double) noexcept;
+  double (*max)(const double*, std::size_t, double) noexcept;
+  double (*product)(const double*, std::size_t, double) noexcept;
+};
+
+// SCALAR
+
+auto sum_scalar(const double* numbers,
+                std::size_t size,
+                CompensatedSum& acc) noexcept -> void {
+  for (std::size_t i{0}; i < size; ++i) {
+    acc.add(numbers[i]);
+  }
+}
+
+auto min_scalar(const double* numbers, std::size_t size, double acc) noexcept
+    -> double {
+  for (std::size_t i{0}; i < size; ++i) {
+    acc = std::min(acc, numbers[i]);
+  }
+  return acc;
+}
+
+auto max_scalar(const double* numbers, std::size_t size, double acc) noexcept
+    -> double {
+  for (std::size_t i{0}; i < size; ++i) {
+    acc = std::max(acc, numbers[i]);
+  }
+  return acc;
+}
+
+auto product_scalar(const double* numbers,
+                    std::size_t size,
+                    double acc) noexcept -> double {
+  for (std::size_t i{0}; i < size; ++i) {
+    acc *= numbers[i];
+  }
+  return acc;
+}
+
+constexpr auto SCALAR_KERNELS =
+    Kernels{sum_scalar, min_scalar, max_scalar, product_scalar};
+
+#ifdef MYT_X86_KERNELS
+
+// Every lane keeps its own Kahan sum, lanes and tail are merged into `acc`
+#define MYT_LANE_SUM(PREFIX, VEC, LANES)                                 \
+  auto sum = PREFIX##_setzero_pd();                                      \
+  auto compensation = PREFIX##_setzero_pd();                             \
+  std::size_t i{0};                                                      \
+  for (; i + (LANES) <= size; i += (LANES)) {                            \
+    const VEC y = PREFIX##_sub_pd(PREFIX##_loadu_pd(numbers + i),        \
+                                  compensation);                         \
+    const VEC total = PREFIX##_add_pd(sum, y);                           \
+    compensation = PREFIX##_sub_pd(PREFIX##_sub_pd(total, sum), y);      \
+    sum = total;                                                         \
+  }                                                                      \
+  double sums[LANES];                                                    \
+  double compensations[LANES];                                           \
+  PREFIX##_storeu_pd(sums, sum);                                         \
+  PREFIX##_storeu_pd(compensations, compensation);                       \
+  for (std::size_t lane{0}; lane < (LANES); ++lane) {                    \
+    acc.add(sums[lane]);                                                 \
+    acc.add(-compensations[lane]);                                       \
+  }                                                                      \
+  sum_scalar(numbers + i, size - i, acc);
+
+#define MYT_LANE_FOLD(PREFIX, VEC, LANES, OP, SCALAR)                 \
+  auto lanes = PREFIX##_set1_pd(acc);                                 \
+  std::size_t i{0};                                                   \
+  for (; i + (LANES) <= size; i += (LANES)) {                         \
+    lanes = PREFIX##_##OP##_pd(lanes, PREFIX##_loadu_pd(numbers + i)); \
+  }                                                                   \
+  double values[LANES];                                               \
+  PREFIX##_storeu_pd(values, lanes);                                  \
+  return SCALAR(values + 1, (LANES) - 1,                              \
+                SCALAR(numbers + i, size - i, values[0]));
+
+// SSE2
+
+auto sum_sse2(const double* numbers,
+              std::size_t size,
+              CompensatedSum& acc) noexcept -> void {
+  MYT_LANE_SUM(_mm, __m128d, 2)
+}
+
+auto min_sse2(const double* numbers, std::size_t size, double acc) noexcept
+    -> double {
+  MYT_LANE_FOLD(_mm, __m128d, 2, min, min_scalar)
+}
+
+auto max_sse2(const double* numbers, std::size_t size, double acc) noexcept
+    -> double {
+  MYT_LANE_FOLD(_mm, __m128d, 2, max, max_scalar)
+}
+
+auto product_sse2(const double* numbers,
+                  std::size_t size,
+                  double acc) noexcept -> double {
+  // Every lane starts from `acc`, the others restart from 1
+  auto lanes = _mm_set_pd(1.0, acc);
+  std::size_t i{0};
+  for (; i + 2 <= size; i += 2) {
+    lanes = _mm_mul_pd(lanes, _mm_loadu_pd(numbers + i));
+  }
+  double values[2];
+  _mm_storeu_pd(values, lanes);
+  return product_scalar(numbers + i, size - i, values[0] * values[1]);
+}
+
+// AVX2
+
+__attribute__((target("avx2"))) auto sum_avx2(const double* numbers,
+                                              std::size_t size,
+                                              CompensatedSum& acc) noexcept
+    -> void {
+  MYT_LANE_SUM(_mm256, __m256d, 4)
+}
+
+__attribute__((target("avx2"))) auto min_avx2(const double* numbers,
+                                              std::size_t size,
+                                              double acc) noexcept -> double {
+  MYT_LANE_FOLD(_mm256, __m256d, 4, min, min_scalar)
+}
+
+__attribute__((target("avx2"))) auto max_avx2(const double* numbers,
+                                              std::size_t size,
+                                              double acc) noexcept -> double {
+  MYT_LANE_FOLD(_mm256, __m256d, 4, max, max_scalar)
+}
+
+__attribute__((target("avx2"))) auto product_avx2(const double* numbers,
+                                                  std::size_t size,
+                                                  double acc) noexcept
+    -> double {
+  auto lanes = _mm256_set_pd(1.0, 1.0, 1.0, acc);
+  std::size_t i{0};
+  for (; i + 4 <= size; i += 4) {
+    lanes = _mm256_mul_pd(lanes, _mm256_loadu_pd(numbers + i));
+  }
+  double values[4];
+  _mm256_storeu_pd(values, lanes);
+  return product_scalar(numbers + i, size - i,
+                        values[0] * values[1] * values[2] * values[3]);
+}
+
+#undef MYT_LANE_SUM
+#undef MYT_LANE_FOLD
+
+constexpr auto SSE2_KERNELS = Kernels{sum_sse2, min_sse2, max_sse2,
+                                      product_sse2};
+constexpr auto AVX2_KERNELS = Kernels{sum_avx2, min_avx2, max_avx2,
+                                      product_avx2};
+
+#endif  // MYT_X86_KERNELS
+
+[[nodiscard]] auto kernels_for(const Isa& isa) noexcept -> const Kernels& {
+#ifdef MYT_X86_KERNELS
+  switch (isa) {
+    case Isa::Avx2:
+      return AVX2_KERNELS;
+    case Isa::Sse2:
+      return SSE2_KERNELS;
+    case Isa::Scalar:
+      break;
+  }
+#endif
+  static_cast<void>(isa);
+  return SCALAR_KERNELS;
+}
+
+// Bits of `mask` in the inclusive offsets [first, last]
+[[nodiscard]] auto slice(const CellBlock::Mask& mask,
+                         const std::size_t& first,
+                         const std::size_t& last) noexcept
+    -> CellBlock::Mask {
+  const auto above = CellBlock::ROWS - 1 - last;
+  return ((mask << above) >> (above + first)) << first;
+}
+
+class Folder {
+ public:
+  Folder(const Op& op, const Kernels& kernels) : m_op(op), m_kernels(kernels) {}
+
+  auto add(const MytValue& value) noexcept -> void {
+    if (!value.is_numeric()) {
+      return;
+    }
+    const auto number = value.get_number();
+    m_seen_float |= value.tag() == MytValue::Tag::Float;
+    add_numbers(&number, 1);
+  }
+
+  auto add(const ArrayObject& array) noexcept -> void {
+    for (std::size_t i{0}; i < array.size(); ++i) {
+      const auto kind = array.kinds()[i];
+      if (kind != ArrayObject::Kind::Int && kind != ArrayObject::Kind::Float) {
+        continue;
+      }
+      m_seen_float |= kind == ArrayObject::Kind::Float;
+      add_numbers(&array.numbers()[i], 1);
+    }
+  }
+
+  // Non numeric offsets hold 0 in `numbers()`, sums read whole slices and
+  // the other folds read the runs of numeric offsets
+  auto add(const CellBlock& block,
+           const std::size_t& first,
+           const std::size_t& last) noexcept -> void {
+    const auto numeric = slice(block.numeric(), first, last);
+    const auto n_numeric = numeric.count();
+    if (n_numeric == 0) {
+      return;
+    }
+    m_seen_float |= slice(block.floats(), first, last).any();
+    const auto numbers = block.numbers().data();
+    const auto width = last - first + 1;
+    if (n_numeric == width || m_op == Op::Sum || m_op == Op::Avg ||
+        m_op == Op::Count) {
+      fold_span(numbers + first, width);
+      m_count += n_numeric;
+      return;
+    }
+    for (auto offset = first; offset <= last;) {
+      if (!numeric.test(offset)) {
+        ++offset;
+        continue;
+      }
+      auto run_end = offset;
+      while (run_end <= last && numeric.test(run_end)) {
+        ++run_end;
+      }
+      add_numbers(numbers + offset, run_end - offset);
+      offset = run_end;
+    }
+  }
+
+  auto add(const AggregateIndex::Totals& totals) noexcept -> void {
+    if (totals.count == 0) {
+      return;
+    }
+    m_sum.add(totals.sum.sum);
+    m_sum.compensation += totals.sum.compensation;
+    m_min = std::min(m_min, totals.min);
+    m_max = std::max(m_max, totals.max);
+    m_product *= totals.product;
+    m_count += totals.count;
+    m_seen_float |= totals.has_floats;
+  }
+
+  [[nodiscard]] auto result() const noexcept -> MytValue {
+    switch (m_op) {
+      case Op::Sum:
+        return number_result(m_sum.result());
+      case Op::Avg:
+        if (m_count == 0) {
+          return MytValue::error("Can't divide by 0");
+        }
+        return MytValue::from_float(static_cast<FloatType>(
+            m_sum.result() / static_cast<double>(m_count)));
+      case Op::Min:
+        return number_result(m_count == 0 ? 0.0 : m_min);
+      case Op::Max:
+        return number_result(m_count == 0 ? 0.0 : m_max);
+      case Op::Count:
+        return MytValue::from_int(static_cast<int>(
+            std::min<std::size_t>(m_count, std::numeric_limits<int>::max())));
+      case Op::Product:
+        return number_result(m_count == 0 ? 0.0 : m_product);
+    }
+    return MytValue{};
+  }
+
+ private:
+  auto add_numbers(const double* numbers, const std::size_t& size) noexcept
+      -> void {
+    fold_span(numbers, size);
+    m_count += size;
+  }
+
+  auto fold_span(const double* numbers, const std::size_t& size) noexcept
+      -> void {
+    switch (m_op) {
+      case Op::Sum:
+      case Op::Avg:
+        m_kernels.sum(numbers, size, m_sum);
+        break;
+      case Op::Min:
+        m_min = m_kernels.min(numbers, size, m_min);
+        break;
+      case Op::Max:
+        m_max = m_kernels.max(numbers, size, m_max);
+        break;
+      case Op::Product:
+        m_product = m_kernels.product(numbers, size, m_product);
+        break;
+      case Op::Count:
+        break;
+    }
+  }
+
+  [[nodiscard]] auto number_result(const double& number) const noexcept
+      -> MytValue {
+    constexpr auto int_min =
+        static_cast<double>(std::numeric_limits<int>::min());
+    constexpr auto int_max =
+        static_cast<double>(std::numeric_limits<int>::max());
+    if (!m_seen_float && number >= int_min && number <= int_max) {
+      return MytValue::from_int(static_cast<int>(number));
+    }
+    return MytValue::from_float(static_cast<FloatType>(number));
+  }
+
+  Op m_op;
+  const Kernels& m_kernels;
+  CompensatedSum m_sum{};
+  double m_min{std::numeric_limits<double>::infinity()};
+  double m_max{-std::numeric_limits<double>::infinity()};
+  double m_product{1.0};
+  std::size_t m_count{0};
+  bool m_seen_float{false};
+};
+
+}  // namespace
+
+auto Aggregate::fold(const Op& op, const std::vector<MytValue>& args) noexcept
+    -> MytValue {
+  return Aggregate::fold(op, args, Aggregate::supported().front());
+}
+
+auto Aggregate::fold(const Op& op,
+                     const std::vector<MytValue>& args,
+                     const Isa& isa) noexcept -> MytValue {
+  auto folder = Folder{op, kernels_for(isa)};
+  for (const auto& arg : args) {
+    if (const auto range = D_CAST(CellRangeObject, arg.get_object())) {
+      const auto is_view = range->for_each_block(
+          [&folder](const CellBlock& block, const std::size_t& first,
+                    const std::size_t& last) {
+            folder.add(block, first, last);
+          },
+          [&folder](const AggregateIndex::Totals& totals) {
+            folder.add(totals);
+          });
+      if (!is_view) {
+        range->for_each_occupied(
+            [&folder](const std::size_t&, const MytValue& value) {
+              folder.add(value);
+            });
+      }
+    } else if (const auto array = D_CAST(ArrayObject, arg.get_object())) {
+      folder.add(*array);
+    } else {
+      folder.add(arg);
+    }
+  }
+  return folder.result();
+}
+
+auto Aggregate::supported() noexcept -> const std::vector<Isa>& {
+  static const auto isas = [] {
+    std::vector<Isa> detected{};
+#ifdef MYT_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+      detected.push_back(Isa::Avx2);
+    }
+    detected.push_back(Isa::Sse2);
+#endif
+    detected.push_back(Isa::Scalar);
+    return detected;
+  }();
+  return isas;
+}
@@ -0,0 +1,26 @@
+#include "../../../include/backend/myt_lang/arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+auto Arena::allocate(const std::size_t& size, const std::size_t& align) noexcept
+    -> void* {
+  const auto padding_for = [&align](const std::byte* ptr) {
+    const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+    return static_cast<std::size_t>((align - addr % align) % align);
+  };
+
+  auto padding = padding_for(m_cur);
+  if (padding + size > static_cast<std::size_t>(m_end - m_cur)) {
+    const auto block_bytes =
+        std::max({MIN_BLOCK_BYTES, m_last_block_bytes * 2, size + align});
+    m_blocks.push_back(std::make_unique<std::byte[]>(block_bytes));
+    m_last_block_bytes = block_bytes;
+    m_cur = m_blocks.back().get();
+    m_end = m_cur + block_bytes;
+    padding = padding_for(m_cur);
+  }
+  const auto start = m_cur + padding;
+  m_cur = start + size;
+  return start;
+}
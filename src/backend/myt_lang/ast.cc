@@ -2,6 +2,14 @@
 
 #include "backend/myt_lang/evaluator.hpp"
 
+auto ExpressionDeleter::operator()(Expression* expr) const noexcept -> void {
+  if (in_arena) {
+    expr->~Expression();
+  } else {
+    delete expr;
+  }
+}
+
 auto AstUtils::token_to_precendece(const TokenType& type) noexcept
     -> Precendence {
   switch (type) {
@@ -28,27 +36,32 @@ auto AstUtils::token_to_precendece(const TokenType& type) noexcept
   }
 }
 
-auto AstUtils::same_hash_code(const Expression& lhs,
-                              const Expression& rhs) noexcept -> bool {
-  return typeid(lhs).hash_code() == typeid(rhs).hash_code();
+auto AstUtils::same_kind(const Expression& lhs,
+                         const Expression& rhs) noexcept -> bool {
+  return lhs.kind() == rhs.kind();
+}
+
+auto ExpressionCellRange::resolve_bounds() const noexcept
+    -> std::optional<std::tuple<CellPos, CellPos>> {
+  const auto& lhs = get_lhs_expression();
+  const auto& rhs = get_rhs_expression();
+  if (lhs.kind() != ExpressionKind::Cell ||
+      rhs.kind() != ExpressionKind::Cell) {
+    return std::nullopt;
+  }
+
+  const auto& pos_a = static_cast<const ExpressionCell&>(lhs).get_pos();
+  const auto& pos_b = static_cast<const ExpressionCell&>(rhs).get_pos();
+  return (pos_a < pos_b) ? std::make_tuple(pos_a, pos_b)
+                         : std::make_tuple(pos_b, pos_a);
 }
 
 auto ExpressionCellRange::generate_range() const noexcept
     -> const std::vector<CellPos> {
-  auto lhs_cell = dynamic_cast<const ExpressionCell*>(&get_lhs_expression());
-  auto rhs_cell = dynamic_cast<const ExpressionCell*>(&get_rhs_expression());
-  if (lhs_cell == nullptr || rhs_cell == nullptr) {
+  if (!m_bounds) {
     return {};
   }
-
-  const auto lhs_pos_str = lhs_cell->get_cell_token().literal;
-  const auto rhs_pos_str = rhs_cell->get_cell_token().literal;
-
-  const auto pos_a = CellPos{lhs_pos_str};
-  const auto pos_b = CellPos{rhs_pos_str};
-
-  const auto [begin, end] = (pos_a < pos_b) ? std::make_tuple(pos_a, pos_b)
-                                            : std::make_tuple(pos_b, pos_a);
+  const auto& [begin, end] = *m_bounds;
 
   std::vector<CellPos> ret_val{};
   for (auto i{begin.col}; i <= end.col; ++i) {
@@ -61,20 +74,18 @@ auto ExpressionCellRange::generate_range() const noexcept
 
 auto ExpressionCellRange::get_cells_strs() const noexcept
     -> const std::tuple<std::string, std::string> {
-  auto lhs_cell = dynamic_cast<const ExpressionCell*>(&get_lhs_expression());
-  auto rhs_cell = dynamic_cast<const ExpressionCell*>(&get_rhs_expression());
-  if (lhs_cell == nullptr || rhs_cell == nullptr) {
+  const auto& lhs = get_lhs_expression();
+  const auto& rhs = get_rhs_expression();
+  if (lhs.kind() != ExpressionKind::Cell ||
+      rhs.kind() != ExpressionKind::Cell) {
     return {};
   }
 
-  const auto lhs_pos_str = lhs_cell->get_cell_token().literal;
-  const auto rhs_pos_str = rhs_cell->get_cell_token().literal;
-
-  const auto pos_a = CellPos{lhs_pos_str};
-  const auto pos_b = CellPos{rhs_pos_str};
-
-  const auto [lhs_str, rhs_str] =
-      (pos_a < pos_b) ? std::make_tuple(lhs_pos_str, rhs_pos_str)
-                      : std::make_tuple(rhs_pos_str, lhs_pos_str);
-  return {lhs_str, rhs_str};
+  const auto& lhs_cell = static_cast<const ExpressionCell&>(lhs);
+  const auto& rhs_cell = static_cast<const ExpressionCell&>(rhs);
+  const auto& lhs_pos_str = lhs_cell.get_cell_token().literal;
+  const auto& rhs_pos_str = rhs_cell.get_cell_token().literal;
+  return (lhs_cell.get_pos() < rhs_cell.get_pos())
+             ? std::make_tuple(lhs_pos_str, rhs_pos_str)
+             : std::make_tuple(rhs_pos_str, lhs_pos_str);
 }
@@ -1,44 +1,55 @@
 #include "../../../include/backend/myt_lang/cell_pos.hpp"
 
-#include <cmath>
 #include "global_utils/global_utils.hpp"
 
-auto CellPos::convert_number(const std::string_view& valid_format_str,
-                             const std::string_view& number) const
-    -> CellLimitType {
-  const auto numbers_ull = std::stoull(number.data());
-  if (!GlobalUtils::is_in_cell_range(numbers_ull)) {
-    const auto msg = "Invalid range in: `" + std::string(valid_format_str) +
-                     "` max: `" + std::to_string(GlobalUtils::CELL_MAX_LIMIT) +
-                     "`";
-    throw InvalidCellString(msg.c_str());
-  }
-  return static_cast<CellLimitType>(numbers_ull);
+namespace {
+[[noreturn]] auto throw_invalid_range(const std::string_view& cell_str)
+    -> void {
+  const auto msg = "Invalid range in: `" + std::string(cell_str) + "` max: `" +
+                   std::to_string(GlobalUtils::CELL_MAX_IDX) + "`";
+  throw InvalidCellString(msg.c_str());
 }
+}  // namespace
 
-auto CellPos::convert_letters(const std::string_view& valid_format_str,
-                              const std::string_view& letters) const
-    -> CellLimitType {
-  const auto acc = [](const auto& s, const auto& e, uint32_t init,
-                      const auto& op) {
-    for (auto [it, idx] = std::tuple{s, uint32_t{}}; it != e; ++it, ++idx) {
-      init += op(*it, idx);
+CellPos::CellPos(const std::string_view& valid_format_str) {
+  // Both accumulators stop growing at the limit, so long inputs can't wrap
+  const auto& str = valid_format_str;
+  std::size_t idx{0};
+  uint32_t letters{0};
+  for (; idx < str.size() && str[idx] >= 'A' && str[idx] <= 'Z'; ++idx) {
+    letters = letters * 26 + static_cast<uint32_t>(str[idx] - 'A' + 1);
+    if (!GlobalUtils::is_in_cell_range(letters)) {
+      throw_invalid_range(valid_format_str);
+    }
+  }
+  uint32_t number{0};
+  for (; idx < str.size(); ++idx) {
+    number = number * 10 + static_cast<uint32_t>(str[idx] - '0');
+    if (!GlobalUtils::is_in_cell_range(number)) {
+      throw_invalid_range(valid_format_str);
     }
-    return init;
-  };
-  const auto index_op = [](const char& c, const auto& idx) {
-    return static_cast<uint32_t>(std::pow(26, idx) * (c - 'A' + 1));
-  };
-  const auto converted = acc(letters.crbegin(), letters.crend(), 0, index_op);
-  if (!GlobalUtils::is_in_cell_range(converted)) {
-    const auto msg = "Invalid range in: `" + std::string(valid_format_str) +
-                     "` max: `" + std::to_string(GlobalUtils::CELL_MAX_LIMIT) +
-                     "`";
-    throw InvalidCellString(msg.c_str());
   }
-  return static_cast<CellLimitType>(converted);
+  if (letters == 0 || number == 0) {
+    throw_invalid_range(valid_format_str);
+  }
+  col = static_cast<CellLimitType>(letters);
+  row = static_cast<CellLimitType>(number);
+}
+
+auto CellPos::to_chars(char* out) const noexcept -> std::size_t {
+  const auto n_letters = GlobalUtils::col_idx_to_letters(col, out);
+  std::size_t n_digits{0};
+  for (auto i = row; i > 0; i /= 10) {
+    n_digits++;
+  }
+  auto idx = n_letters + n_digits;
+  for (auto i = row; i > 0; i /= 10) {
+    out[--idx] = static_cast<char>('0' + i % 10);
+  }
+  return n_letters + n_digits;
 }
 
 auto CellPos::to_string() const noexcept -> const std::string {
-  return GlobalUtils::col_idx_to_letter_str(col) + std::to_string(row);
+  char buffer[MAX_A1_LENGTH]{};
+  return std::string(buffer, to_chars(buffer));
 }
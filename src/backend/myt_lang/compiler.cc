@@ -0,0 +1,362 @@
+#include "../../../include/backend/myt_lang/compiler.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <variant>
+
+#include "backend/myt_lang/evaluator.hpp"
+#include "backend/myt_lang/myt_builtins.hpp"
+#include "backend/myt_lang/myt_object.hpp"
+#include "backend/myt_lang/token.hpp"
+#include "backend/myt_lang/vm.hpp"
+#include "backend/page.hpp"
+
+auto Compiler::compile(const ParsingResult& parsed) noexcept
+    -> std::optional<Program> {
+  Context ctx{};
+  if (std::holds_alternative<ParsingError>(parsed)) {
+    const auto& err = std::get<ParsingError>(parsed);
+    emit_const(ctx, MytValue::error(err.content));
+    return ctx.program;
+  }
+
+  const auto& expr = std::get<ExpressionSharedPtr>(parsed);
+  if (!Compiler::compile_expression(*expr, ctx)) {
+    return std::nullopt;
+  }
+  return ctx.program;
+}
+
+auto Compiler::compile_expression(const Expression& expr,
+                                  Context& ctx) noexcept -> bool {
+  return AstUtils::visit(
+      expr,
+      AstUtils::Overloaded{
+          [&ctx](const ExpressionLiteral<int>& expr_int) {
+            emit_const(ctx, MytValue::from_int(expr_int.get_value()));
+            return true;
+          },
+          [&ctx](const ExpressionLiteral<std::string>& expr_str) {
+            emit_const(ctx, MytValue::from_object(MS_VO_T(
+                                std::string, expr_str.get_value())));
+            return true;
+          },
+          [&ctx](const ExpressionLiteral<bool>& expr_bool) {
+            emit_const(ctx, MytValue::from_bool(expr_bool.get_value()));
+            return true;
+          },
+          [&ctx](const ExpressionLiteral<FloatType>& expr_float) {
+            emit_const(ctx, MytValue::from_float(expr_float.get_value()));
+            return true;
+          },
+          [&ctx](const ExpressionIdentifier& expr_ident) {
+            emit_const(ctx, MytValue::from_object(MS_T(
+                                IdentObject,
+                                expr_ident.get_name_token().literal)));
+            return true;
+          },
+          [&ctx](const ExpressionCell& expr_cell) {
+            emit_op(ctx, OpCode::LoadCell, ctx.program.cells.size());
+            ctx.program.cells.push_back(expr_cell.get_pos());
+            return true;
+          },
+          [&ctx](const ExpressionPrefix& expr_prefix) {
+            return compile_prefix(expr_prefix, ctx);
+          },
+          [&ctx](const ExpressionCellRange& expr_range) {
+            return compile_cell_range(expr_range, ctx);
+          },
+          [&ctx](const ExpressionInfix& expr_infix) {
+            return compile_infix(expr_infix, ctx);
+          },
+          [&ctx](const ExpressionFnCall& expr_fn_call) {
+            return compile_fn_call(expr_fn_call, ctx);
+          },
+      });
+}
+
+auto Compiler::compile_prefix(const ExpressionPrefix& expr_prefix,
+                              Context& ctx) noexcept -> bool {
+  if (!compile_expression(expr_prefix.get_expression(), ctx)) {
+    return false;
+  }
+  switch (expr_prefix.get_prefix_token().type) {
+    case TokenType::Bang:
+      emit_op(ctx, OpCode::Not, 0, 1);
+      fold_constants(ctx, 1);
+      return true;
+    case TokenType::Minus:
+      emit_op(ctx, OpCode::Neg, 0, 1);
+      fold_constants(ctx, 1);
+      return true;
+    default:
+      return false;
+  }
+}
+
+auto Compiler::compile_cell_range(const ExpressionCellRange& expr_range,
+                                  Context& ctx) noexcept -> bool {
+  const auto bounds = expr_range.get_range_bounds();
+  if (!bounds) {
+    emit_const(ctx, MytValue::error("Wrong type, cell range requires "
+                                    "`CellRow:CellCol`"));
+    return true;
+  }
+  const auto [begin, end] = *bounds;
+  const auto [lhs_str, rhs_str] = expr_range.get_cells_strs();
+  emit_op(ctx, OpCode::LoadRange, ctx.program.ranges.size());
+  ctx.program.ranges.push_back(
+      RangeOperand{begin, end, lhs_str + ":" + rhs_str});
+  return true;
+}
+
+auto Compiler::compile_infix(const ExpressionInfix& expr_infix,
+                             Context& ctx) noexcept -> bool {
+  const auto op_token = expr_infix.get_operator_token();
+  auto op = OpCode::Add;
+  switch (op_token.type) {
+    case TokenType::Plus:
+      op = OpCode::Add;
+      break;
+    case TokenType::Minus:
+      op = OpCode::Sub;
+      break;
+    case TokenType::Asterisk:
+      op = OpCode::Mul;
+      break;
+    case TokenType::Slash:
+      op = OpCode::Div;
+      break;
+    case TokenType::Eq:
+      op = OpCode::Eq;
+      break;
+    case TokenType::NotEq:
+      op = OpCode::NotEq;
+      break;
+    case TokenType::Gt:
+      op = OpCode::Gt;
+      break;
+    case TokenType::Ge:
+      op = OpCode::Ge;
+      break;
+    case TokenType::Lt:
+      op = OpCode::Lt;
+      break;
+    case TokenType::Le:
+      op = OpCode::Le;
+      break;
+    default:
+      // Operands can't fail in a way that would change the result
+      emit_const(ctx,
+                 MytValue::error("Unimplemented operator " + op_token.literal));
+      return true;
+  }
+  if (!compile_expression(expr_infix.get_lhs_expression(), ctx) ||
+      !compile_expression(expr_infix.get_rhs_expression(), ctx)) {
+    return false;
+  }
+  emit_op(ctx, op, 0, 2);
+  fold_constants(ctx, 2);
+  return true;
+}
+
+auto Compiler::compile_fn_call(const ExpressionFnCall& expr_fn_call,
+                               Context& ctx) noexcept -> bool {
+  const auto& builtin = expr_fn_call.get_builtin();
+  const auto& args_expr = expr_fn_call.get_arguments();
+  if (!builtin || args_expr.size() > std::numeric_limits<uint16_t>::max()) {
+    return false;
+  }
+  if (MytBuiltins::get(*builtin).lazy) {
+    return compile_lazy_call(*builtin, args_expr, ctx);
+  }
+
+  for (const auto& arg_expr : args_expr) {
+    if (!compile_expression(*arg_expr, ctx)) {
+      return false;
+    }
+  }
+  const auto argc = static_cast<uint16_t>(args_expr.size());
+  emit_op(ctx, OpCode::CallBuiltin, static_cast<std::size_t>(*builtin), argc,
+          argc);
+  // Builtins are pure, so calls over constants fold too, `Pi()` included
+  fold_constants(ctx, argc);
+  return true;
+}
+
+auto Compiler::compile_lazy_call(const BuiltinId& builtin,
+                                 const Arguments& args_expr,
+                                 Context& ctx) noexcept -> bool {
+  // Every path leaves exactly one value above `depth`
+  const auto depth = ctx.depth;
+  Jumps end_jumps{};
+  switch (builtin) {
+    case BuiltinId::If: {
+      if (!compile_condition(builtin, *args_expr[0], end_jumps, ctx)) {
+        return false;
+      }
+      const auto else_jump = emit_jump(ctx, OpCode::JumpIfFalse, 1);
+      if (!compile_expression(*args_expr[1], ctx)) {
+        return false;
+      }
+      end_jumps.push_back(emit_jump(ctx, OpCode::Jump));
+      bind_jumps(ctx, {else_jump});
+      ctx.depth = depth;
+      if (args_expr.size() > 2) {
+        if (!compile_expression(*args_expr[2], ctx)) {
+          return false;
+        }
+      } else {
+        emit_const(ctx, MytValue::from_bool(false));
+      }
+      break;
+    }
+    case BuiltinId::And:
+    case BuiltinId::Or: {
+      const auto short_circuit = builtin == BuiltinId::Or;
+      const auto short_op = short_circuit ? OpCode::JumpIfTrue
+                                          : OpCode::JumpIfFalse;
+      Jumps short_jumps{};
+      for (const auto& arg_expr : args_expr) {
+        if (!compile_condition(builtin, *arg_expr, end_jumps, ctx)) {
+          return false;
+        }
+        short_jumps.push_back(emit_jump(ctx, short_op, 1));
+      }
+      emit_const(ctx, MytValue::from_bool(!short_circuit));
+      end_jumps.push_back(emit_jump(ctx, OpCode::Jump));
+      bind_jumps(ctx, short_jumps);
+      ctx.depth = depth;
+      emit_const(ctx, MytValue::from_bool(short_circuit));
+      break;
+    }
+    case BuiltinId::IfError: {
+      if (!compile_expression(*args_expr[0], ctx)) {
+        return false;
+      }
+      end_jumps.push_back(emit_jump(ctx, OpCode::JumpUnlessError));
+      emit_jump(ctx, OpCode::Pop, 1);
+      if (!compile_expression(*args_expr[1], ctx)) {
+        return false;
+      }
+      break;
+    }
+    case BuiltinId::Choose: {
+      if (!compile_expression(*args_expr[0], ctx)) {
+        return false;
+      }
+      const auto n_choices = args_expr.size() - 1;
+      const auto table_idx = ctx.program.jump_tables.size();
+      ctx.program.jump_tables.emplace_back();
+      emit_jump(ctx, OpCode::Switch, 1);
+      ctx.program.code.back().operand = static_cast<uint32_t>(table_idx);
+      ctx.program.code.back().argc = static_cast<uint16_t>(n_choices);
+      for (std::size_t i{1}; i <= n_choices; ++i) {
+        ctx.fold_floor = ctx.program.code.size();
+        ctx.program.jump_tables[table_idx].push_back(
+            static_cast<uint32_t>(ctx.program.code.size()));
+        ctx.depth = depth;
+        if (!compile_expression(*args_expr[i], ctx)) {
+          return false;
+        }
+        end_jumps.push_back(emit_jump(ctx, OpCode::Jump));
+      }
+      ctx.program.jump_tables[table_idx].push_back(
+          static_cast<uint32_t>(ctx.program.code.size()));
+      break;
+    }
+    default:
+      return false;
+  }
+  bind_jumps(ctx, end_jumps);
+  ctx.depth = depth + 1;
+  return true;
+}
+
+auto Compiler::compile_condition(const BuiltinId& builtin,
+                                 const Expression& expr,
+                                 Jumps& error_jumps,
+                                 Context& ctx) noexcept -> bool {
+  if (!compile_expression(expr, ctx)) {
+    return false;
+  }
+  emit_op(ctx, OpCode::ToBool, static_cast<std::size_t>(builtin), 1);
+  error_jumps.push_back(emit_jump(ctx, OpCode::JumpIfError));
+  return true;
+}
+
+auto Compiler::emit_op(Context& ctx,
+                       const OpCode& op,
+                       const std::size_t& operand,
+                       const std::size_t& n_pops,
+                       const uint16_t& argc) noexcept -> void {
+  ctx.program.code.push_back(
+      Instruction{op, argc, static_cast<uint32_t>(operand)});
+  ctx.depth = ctx.depth - n_pops + 1;
+  ctx.program.max_stack = std::max(ctx.program.max_stack, ctx.depth);
+}
+
+auto Compiler::emit_const(Context& ctx, MytValue&& value) noexcept -> void {
+  emit_op(ctx, OpCode::PushConst, ctx.program.constants.size());
+  ctx.program.constants.push_back(std::move(value));
+}
+
+auto Compiler::fold_constants(Context& ctx,
+                              const std::size_t& n_operands) noexcept
+    -> void {
+  auto& program = ctx.program;
+  if (program.code.size() < n_operands + 1) {
+    return;
+  }
+  const auto first = program.code.size() - n_operands - 1;
+  if (first < ctx.fold_floor) {
+    return;
+  }
+  for (auto i = first; i + 1 < program.code.size(); ++i) {
+    if (program.code[i].op != OpCode::PushConst) {
+      return;
+    }
+  }
+
+  // Trailing constants are pushed in order, so the operands are the last
+  // `n_operands` entries of `constants`
+  const auto first_const = program.constants.size() - n_operands;
+  Program folding{};
+  folding.max_stack = std::max<std::size_t>(n_operands, 1);
+  folding.constants.assign(
+      std::make_move_iterator(program.constants.begin() +
+                              static_cast<std::ptrdiff_t>(first_const)),
+      std::make_move_iterator(program.constants.end()));
+  for (std::size_t i{0}; i < n_operands; ++i) {
+    folding.code.push_back(
+        Instruction{OpCode::PushConst, 0, static_cast<uint32_t>(i)});
+  }
+  folding.code.push_back(program.code.back());
+  auto folded = Vm::execute(folding, Page{});
+
+  program.code.resize(first);
+  program.constants.resize(first_const);
+  program.code.push_back(Instruction{
+      OpCode::PushConst, 0, static_cast<uint32_t>(program.constants.size())});
+  program.constants.push_back(std::move(folded));
+}
+
+auto Compiler::emit_jump(Context& ctx,
+                         const OpCode& op,
+                         const std::size_t& n_pops) noexcept -> std::size_t {
+  ctx.program.code.push_back(Instruction{op});
+  ctx.depth -= n_pops;
+  return ctx.program.code.size() - 1;
+}
+
+auto Compiler::bind_jumps(Context& ctx, const Jumps& jumps) noexcept -> void {
+  const auto target = ctx.program.code.size();
+  for (const auto& jump : jumps) {
+    ctx.program.code[jump].operand = static_cast<uint32_t>(target);
+  }
+  ctx.fold_floor = target;
+}
@@ -0,0 +1,265 @@
+#include "../../../include/backend/myt_lang/element_wise.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "backend/myt_lang/evaluator.hpp"
+
+namespace {
+
+using Kind = ArrayObject::Kind;
+
+struct ArrayLanes {
+  const double* numbers;
+  const Kind* kinds;
+
+  [[nodiscard]] auto number(const std::size_t& i) const noexcept -> double {
+    return numbers[i];
+  }
+  [[nodiscard]] auto kind(const std::size_t& i) const noexcept -> Kind {
+    return kinds[i];
+  }
+};
+
+// A scalar operand repeated on every lane
+struct ScalarLanes {
+  double value;
+  Kind value_kind;
+
+  [[nodiscard]] auto number([[maybe_unused]] const std::size_t& i)
+      const noexcept -> double {
+    return value;
+  }
+  [[nodiscard]] auto kind([[maybe_unused]] const std::size_t& i) const noexcept
+      -> Kind {
+    return value_kind;
+  }
+};
+
+[[nodiscard]] constexpr auto is_number(const Kind& kind) noexcept -> bool {
+  return kind == Kind::Int || kind == Kind::Float;
+}
+
+[[nodiscard]] auto to_scalar_lanes(const MytValue& value) noexcept
+    -> ScalarLanes {
+  switch (value.tag()) {
+    case MytValue::Tag::Int:
+      return ScalarLanes{value.get_number(), Kind::Int};
+    case MytValue::Tag::Float:
+      return ScalarLanes{value.get_number(), Kind::Float};
+    case MytValue::Tag::Bool:
+      return ScalarLanes{value.get_bool() ? 1.0 : 0.0, Kind::Bool};
+    default:
+      return ScalarLanes{0.0, Kind::Other};
+  }
+}
+
+// Ranges are converted into `storage`, arrays are used in place
+[[nodiscard]] auto as_array(const MytValue& value,
+                            std::optional<ArrayObject>& storage) noexcept
+    -> const ArrayObject* {
+  const auto obj = value.get_object();
+  if (const auto array = D_CAST(ArrayObject, obj)) {
+    return array;
+  }
+  if (const auto range = D_CAST(CellRangeObject, obj)) {
+    return &storage.emplace(*range);
+  }
+  return nullptr;
+}
+
+// Both results are computed on every lane and selected, keeping the loop free
+// of branches. Ints are exact in double, int results out of the `int` range
+// become floats instead of overflowing.
+template <typename Lhs, typename Rhs, typename Op>
+auto arithmetic_lanes(const Lhs& lhs,
+                      const Rhs& rhs,
+                      const bool& is_div,
+                      Op&& op,
+                      const std::size_t& size,
+                      double* out,
+                      Kind* out_kinds) noexcept -> void {
+  constexpr auto int_min =
+      static_cast<double>(std::numeric_limits<int>::min());
+  constexpr auto int_max =
+      static_cast<double>(std::numeric_limits<int>::max());
+  for (std::size_t i{0}; i < size; ++i) {
+    const auto a = lhs.number(i);
+    const auto b = rhs.number(i);
+    const auto lhs_kind = lhs.kind(i);
+    const auto rhs_kind = rhs.kind(i);
+    // Division by zero is an error, left to the scalar path
+    const auto numbers = is_number(lhs_kind) && is_number(rhs_kind) &&
+                         !(is_div && b == 0.0);
+    const auto ints = lhs_kind == Kind::Int && rhs_kind == Kind::Int;
+
+    auto int_result = op(a, b);
+    int_result = is_div ? std::trunc(int_result) : int_result;
+    const auto float_result = static_cast<double>(
+        op(static_cast<FloatType>(a), static_cast<FloatType>(b)));
+    const auto int_lane =
+        ints && int_result >= int_min && int_result <= int_max;
+
+    out[i] = int_lane ? int_result : float_result;
+    out_kinds[i] =
+        numbers ? (int_lane ? Kind::Int : Kind::Float) : Kind::Other;
+  }
+}
+
+template <typename Lhs, typename Rhs, typename Cmp>
+auto compare_lanes(const Lhs& lhs,
+                   const Rhs& rhs,
+                   Cmp&& cmp,
+                   const std::size_t& size,
+                   double* out,
+                   Kind* out_kinds) noexcept -> void {
+  for (std::size_t i{0}; i < size; ++i) {
+    const auto lhs_kind = lhs.kind(i);
+    const auto rhs_kind = rhs.kind(i);
+    const auto comparable =
+        (is_number(lhs_kind) && is_number(rhs_kind)) ||
+        (lhs_kind == Kind::Bool && rhs_kind == Kind::Bool);
+    out[i] = cmp(lhs.number(i), rhs.number(i)) ? 1.0 : 0.0;
+    out_kinds[i] = comparable ? Kind::Bool : Kind::Other;
+  }
+}
+
+template <typename Lhs, typename Rhs>
+auto run_lanes(const BinaryOp& op,
+               const Lhs& lhs,
+               const Rhs& rhs,
+               const std::size_t& size,
+               double* out,
+               Kind* out_kinds) noexcept -> void {
+  const auto arithmetic = [&](auto&& fn, const bool& is_div) {
+    arithmetic_lanes(lhs, rhs, is_div, fn, size, out, out_kinds);
+  };
+  const auto comparison = [&](auto&& cmp) {
+    compare_lanes(lhs, rhs, cmp, size, out, out_kinds);
+  };
+  switch (op) {
+    case BinaryOp::Add:
+      arithmetic([](const auto& a, const auto& b) { return a + b; }, false);
+      break;
+    case BinaryOp::Sub:
+      arithmetic([](const auto& a, const auto& b) { return a - b; }, false);
+      break;
+    case BinaryOp::Mul:
+      arithmetic([](const auto& a, const auto& b) { return a * b; }, false);
+      break;
+    case BinaryOp::Div:
+      arithmetic([](const auto& a, const auto& b) { return a / b; }, true);
+      break;
+    case BinaryOp::Eq:
+      comparison([](const double& a, const double& b) { return a == b; });
+      break;
+    case BinaryOp::NotEq:
+      comparison([](const double& a, const double& b) { return a != b; });
+      break;
+    case BinaryOp::Gt:
+      comparison([](const double& a, const double& b) { return a > b; });
+      break;
+    case BinaryOp::Ge:
+      comparison([](const double& a, const double& b) { return a >= b; });
+      break;
+    case BinaryOp::Lt:
+      comparison([](const double& a, const double& b) { return a < b; });
+      break;
+    case BinaryOp::Le:
+      comparison([](const double& a, const double& b) { return a <= b; });
+      break;
+  }
+}
+
+}  // namespace
+
+auto ElementWise::is_array(const MytValue& value) noexcept -> bool {
+  const auto obj = value.get_object();
+  return D_CAST(ArrayObject, obj) != nullptr ||
+         D_CAST(CellRangeObject, obj) != nullptr;
+}
+
+auto ElementWise::apply(const BinaryOp& op,
+                        const MytValue& lhs,
+                        const MytValue& rhs) noexcept -> MytValue {
+  std::optional<ArrayObject> lhs_storage{};
+  std::optional<ArrayObject> rhs_storage{};
+  const auto lhs_array = as_array(lhs, lhs_storage);
+  const auto rhs_array = as_array(rhs, rhs_storage);
+  if (lhs_array == nullptr && rhs_array == nullptr) {
+    return MytValue::binary(op, lhs, rhs);
+  }
+  return ElementWise::apply(op, lhs_array, lhs, rhs_array, rhs);
+}
+
+auto ElementWise::apply(const BinaryOp& op,
+                        const ArrayObject& lhs,
+                        const MytValue& rhs) noexcept -> MytValue {
+  std::optional<ArrayObject> rhs_storage{};
+  const auto rhs_array = as_array(rhs, rhs_storage);
+  return ElementWise::apply(op, &lhs, MytValue{}, rhs_array, rhs);
+}
+
+auto ElementWise::apply(const BinaryOp& op,
+                        const ArrayObject* lhs_array,
+                        const MytValue& lhs,
+                        const ArrayObject* rhs_array,
+                        const MytValue& rhs) noexcept -> MytValue {
+  if (lhs_array != nullptr && rhs_array != nullptr &&
+      lhs_array->size() != rhs_array->size()) {
+    return MytValue::error("Element-wise operation on ranges of sizes: " +
+                           std::to_string(lhs_array->size()) + " and " +
+                           std::to_string(rhs_array->size()));
+  }
+  const auto size =
+      (lhs_array != nullptr) ? lhs_array->size() : rhs_array->size();
+  auto result = std::make_shared<ArrayObject>(size);
+  const auto out = result->m_numbers.data();
+  const auto out_kinds = result->m_kinds.data();
+  const auto lanes = [](const ArrayObject& array) {
+    return ArrayLanes{array.m_numbers.data(), array.m_kinds.data()};
+  };
+
+  if (lhs_array != nullptr && rhs_array != nullptr) {
+    run_lanes(op, lanes(*lhs_array), lanes(*rhs_array), size, out, out_kinds);
+  } else if (lhs_array != nullptr) {
+    run_lanes(op, lanes(*lhs_array), to_scalar_lanes(rhs), size, out,
+              out_kinds);
+  } else {
+    run_lanes(op, to_scalar_lanes(lhs), lanes(*rhs_array), size, out,
+              out_kinds);
+  }
+  ElementWise::fill_other_lanes(op, lhs_array, lhs, rhs_array, rhs, *result);
+  return MytValue::from_object(result);
+}
+
+auto ElementWise::fill_other_lanes(const BinaryOp& op,
+                                   const ArrayObject* lhs_array,
+                                   const MytValue& lhs,
+                                   const ArrayObject* rhs_array,
+                                   const MytValue& rhs,
+                                   ArrayObject& result) noexcept -> void {
+  for (std::size_t i{0}; i < result.size(); ++i) {
+    if (result.m_kinds[i] != Kind::Other) {
+      continue;
+    }
+    const auto lhs_value = (lhs_array != nullptr) ? lhs_array->get(i) : lhs;
+    const auto rhs_value = (rhs_array != nullptr) ? rhs_array->get(i) : rhs;
+    if (ElementWise::is_array(lhs_value) || ElementWise::is_array(rhs_value)) {
+      result.set(i, MytValue::error("Invalid expression: nested cell ranges "
+                                    "are not supported yet"));
+      continue;
+    }
+    if (op == BinaryOp::Div && rhs_value.is_numeric() &&
+        rhs_value.get_number() == 0) {
+      result.set(i, MytValue::from_object(ZERO_DIV_ERR));
+      continue;
+    }
+    result.set(i, MytValue::binary(op, lhs_value, rhs_value));
+  }
+}
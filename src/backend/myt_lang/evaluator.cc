@@ -13,178 +13,200 @@
 #include "backend/page.hpp"
 
 auto Evaluator::evaluate(const ParsingResult& parsed_result,
-                         const CellMap& cells) noexcept -> MytObjectPtr {
+                         const Page& page) noexcept -> MytObjectPtr {
+  return Evaluator::evaluate_value(parsed_result, page).to_object();
+}
+
+auto Evaluator::evaluate_value(const ParsingResult& parsed_result,
+                               const Page& page) noexcept -> MytValue {
   if (std::holds_alternative<ParsingError>(parsed_result)) {
     const auto err = &std::get<ParsingError>(parsed_result);
-    return MS_T(ErrorObject, err->content);
+    return MytValue::error(err->content);
   }
 
   const auto expr = std::get<ExpressionSharedPtr>(parsed_result).get();
-  return Evaluator::evaluate_expression(*expr, cells);
+  return CellRangeObject::detach(Evaluator::evaluate_expression(*expr, page));
 }
 
 auto Evaluator::get_error_obj(const std::string& msg) noexcept -> MytObjectPtr {
   return MS_T(ErrorObject, msg);
 }
 
-auto Evaluator::evaluate_expression(const Expression& expr,
-                                    const CellMap& cells) noexcept
-    -> MytObjectPtr {
-  if (const auto expr_int = D_CAST(ExpressionLiteral<int>, &expr)) {
-    return MS_VO_T(int, expr_int->get_value());
-
-  } else if (const auto expr_int =
-                 D_CAST(ExpressionLiteral<std::string>, &expr)) {
-    return MS_VO_T(std::string, expr_int->get_value());
-
-  } else if (const auto expr_int = D_CAST(ExpressionLiteral<bool>, &expr)) {
-    return MS_VO_T(bool, expr_int->get_value());
-
-  } else if (const auto expr_int =
-                 D_CAST(ExpressionLiteral<FloatType>, &expr)) {
-    return MS_VO_T(FloatType, expr_int->get_value());
-
-  } else if (const auto expr_ident = D_CAST(ExpressionIdentifier, &expr)) {
-    return MS_T(IdentObject, expr_ident->get_name_token().literal);
-
-  } else if (const auto expr_cell = D_CAST(ExpressionCell, &expr)) {
-    return Evaluator::get_from_cells(*expr_cell, cells);
-
-  } else if (const auto expr_prefix = D_CAST(ExpressionPrefix, &expr)) {
-    return Evaluator::eval_prefix(*expr_prefix, cells);
-
-  } else if (const auto expr_cell_range = D_CAST(ExpressionCellRange, &expr)) {
-    return Evaluator::eval_cell_range(*expr_cell_range, cells);
-
-  } else if (const auto expr_infix = D_CAST(ExpressionInfix, &expr)) {
-    return Evaluator::eval_infix(*expr_infix, cells);
-
-  } else if (const auto expr_fn_call = D_CAST(ExpressionFnCall, &expr)) {
-    return Evaluator::eval_fn_call(*expr_fn_call, cells);
-  }
+auto Evaluator::get_cell_range_obj(const CellPos& begin,
+                                   const CellPos& end,
+                                   const std::string& range_str,
+                                   const Page& page) noexcept -> MytValue {
+  return MytValue::from_object(
+      std::make_shared<CellRangeObject>(range_str, page, begin, end));
+}
 
-  return MS_T(NilObject, );
-};
+auto Evaluator::evaluate_expression(const Expression& expr,
+                                    const Page& page) noexcept -> MytValue {
+  return AstUtils::visit(
+      expr,
+      AstUtils::Overloaded{
+          [](const ExpressionLiteral<int>& expr_int) {
+            return MytValue::from_int(expr_int.get_value());
+          },
+          [](const ExpressionLiteral<std::string>& expr_str) {
+            return MytValue::from_object(
+                MS_VO_T(std::string, expr_str.get_value()));
+          },
+          [](const ExpressionLiteral<bool>& expr_bool) {
+            return MytValue::from_bool(expr_bool.get_value());
+          },
+          [](const ExpressionLiteral<FloatType>& expr_float) {
+            return MytValue::from_float(expr_float.get_value());
+          },
+          [](const ExpressionIdentifier& expr_ident) {
+            return MytValue::from_object(
+                MS_T(IdentObject, expr_ident.get_name_token().literal));
+          },
+          [&page](const ExpressionCell& expr_cell) {
+            return Evaluator::get_from_cells(expr_cell, page);
+          },
+          [&page](const ExpressionPrefix& expr_prefix) {
+            return Evaluator::eval_prefix(expr_prefix, page);
+          },
+          [&page](const ExpressionCellRange& expr_cell_range) {
+            return Evaluator::eval_cell_range(expr_cell_range, page);
+          },
+          [&page](const ExpressionInfix& expr_infix) {
+            return Evaluator::eval_infix(expr_infix, page);
+          },
+          [&page](const ExpressionFnCall& expr_fn_call) {
+            return Evaluator::eval_fn_call(expr_fn_call, page);
+          },
+      });
+}
 
 auto Evaluator::get_from_cells(const ExpressionCell& expr_cell,
-                               const CellMap& cells) noexcept -> MytObjectPtr {
-  const auto cell_str = expr_cell.get_cell_token().literal;
-  const auto cell_pos = CellPos{cell_str};
-  if (!Evaluator::is_in_cells(cell_pos, cells)) {
-    return MS_T(NilObject, );
+                               const Page& page) noexcept -> MytValue {
+  const auto data_cell = page.get_cell(expr_cell.get_pos());
+  if (data_cell == nullptr) {
+    return MytValue{};
   }
-  const auto data_cell = cells.at(cell_pos);
-  return data_cell.get_evaluated_content();
+  return data_cell->get_value();
 }
 
 auto Evaluator::eval_prefix(const ExpressionPrefix& expr_prefix,
-                            const CellMap& cells) noexcept -> MytObjectPtr {
+                            const Page& page) noexcept -> MytValue {
   const auto& expr_ref = expr_prefix.get_expression();
-  const auto obj = Evaluator::evaluate_expression(expr_ref, cells);
+  const auto value = Evaluator::evaluate_expression(expr_ref, page);
   const auto prefix_type = expr_prefix.get_prefix_token().type;
   switch (prefix_type) {
     case TokenType::Bang:
-      return Evaluator::eval_prefix_bang(obj);
+      return Evaluator::eval_prefix_bang(value);
     case TokenType::Minus:
-      return Evaluator::eval_prefix_minus(obj);
+      return Evaluator::eval_prefix_minus(value);
     default:
       assert(false && "Unreachable");
   }
-  return MS_T(NilObject, );
+  return MytValue{};
 }
 
-auto Evaluator::eval_prefix_bang(MytObjectPtr obj) noexcept -> MytObjectPtr {
-  if (auto bool_obj = std::dynamic_pointer_cast<ValueObject<bool>>(obj)) {
-    return MS_VO_T(bool, !bool_obj->get_value());
+auto Evaluator::eval_prefix_bang(const MytValue& value) noexcept -> MytValue {
+  if (value.tag() == MytValue::Tag::Bool) {
+    return MytValue::from_bool(!value.get_bool());
   }
-  return MS_T(ErrorObject, "Invalid prefix `!` argument");
+  return MytValue::error("Invalid prefix `!` argument");
 }
 
-auto Evaluator::eval_prefix_minus(MytObjectPtr obj) noexcept -> MytObjectPtr {
-  if (const auto int_obj = DP_CAST_VO_T(int, obj)) {
-    return MS_VO_T(int, -int_obj->get_value());
-  } else if (const auto float_obj = DP_CAST_VO_T(FloatType, obj)) {
-    return MS_VO_T(FloatType, -float_obj->get_value());
+auto Evaluator::eval_prefix_minus(const MytValue& value) noexcept
+    -> MytValue {
+  if (value.tag() == MytValue::Tag::Int) {
+    return MytValue::from_int(-value.get_int());
+  } else if (value.tag() == MytValue::Tag::Float) {
+    return MytValue::from_float(-value.get_float());
   }
-  return MS_T(ErrorObject, "Invalid prefix `-` argument");
+  return MytValue::error("Invalid prefix `-` argument");
 }
 
 auto Evaluator::eval_infix(const ExpressionInfix& expr_infix,
-                           const CellMap& cells) noexcept -> MytObjectPtr {
+                           const Page& page) noexcept -> MytValue {
   const auto& expr_lhs = expr_infix.get_lhs_expression();
   const auto& expr_rhs = expr_infix.get_rhs_expression();
 
-  const auto lhs_obj = Evaluator::evaluate_expression(expr_lhs, cells);
-  const auto rhs_obj = Evaluator::evaluate_expression(expr_rhs, cells);
+  const auto lhs = Evaluator::evaluate_expression(expr_lhs, page);
+  const auto rhs = Evaluator::evaluate_expression(expr_rhs, page);
 
   const auto op_token = expr_infix.get_operator_token();
   switch (op_token.type) {
     case TokenType::Plus:
-      return lhs_obj->add(rhs_obj);
+      return MytValue::add(lhs, rhs);
     case TokenType::Minus:
-      return lhs_obj->sub(rhs_obj);
+      return MytValue::sub(lhs, rhs);
     case TokenType::Asterisk:
-      return lhs_obj->mul(rhs_obj);
+      return MytValue::mul(lhs, rhs);
     case TokenType::Slash:
-      if (const auto float_obj = DP_CAST_VO_T(FloatType, rhs_obj)) {
-        if (float_obj.get()->get_value() == 0)
-          return ZERO_DIV_ERR;
-      } else if (const auto int_obj = DP_CAST_VO_T(int, rhs_obj)) {
-        if (int_obj.get()->get_value() == 0)
-          return ZERO_DIV_ERR;
+      if (rhs.is_numeric() && rhs.get_number() == 0) {
+        return MytValue::from_object(ZERO_DIV_ERR);
       }
-      return lhs_obj->div(rhs_obj);
+      return MytValue::div(lhs, rhs);
+    case TokenType::Eq:
+      return MytValue::compare(BinaryOp::Eq, lhs, rhs);
+    case TokenType::NotEq:
+      return MytValue::compare(BinaryOp::NotEq, lhs, rhs);
+    case TokenType::Gt:
+      return MytValue::compare(BinaryOp::Gt, lhs, rhs);
+    case TokenType::Ge:
+      return MytValue::compare(BinaryOp::Ge, lhs, rhs);
+    case TokenType::Lt:
+      return MytValue::compare(BinaryOp::Lt, lhs, rhs);
+    case TokenType::Le:
+      return MytValue::compare(BinaryOp::Le, lhs, rhs);
     default:
-      return MS_T(ErrorObject, "Unimplemented operator " + op_token.literal);
+      return MytValue::error("Unimplemented operator " + op_token.literal);
   }
-  return MS_T(NilObject, );
+  return MytValue{};
 }
 
 auto Evaluator::eval_cell_range(const ExpressionCellRange& expr_cell_range,
-                                const CellMap& cells) noexcept -> MytObjectPtr {
-  const auto& expr_lhs = expr_cell_range.get_lhs_expression();
-  const auto& expr_rhs = expr_cell_range.get_rhs_expression();
-
-  auto lhs_cell = D_CAST(ExpressionCell, &expr_lhs);
-  auto rhs_cell = D_CAST(ExpressionCell, &expr_rhs);
-  if (lhs_cell == nullptr || rhs_cell == nullptr) {
-    return MS_T(ErrorObject,
-                "Wrong type, cell range requires "
-                "`CellRow:CellCol`");
-  }
-  const auto range_positions = expr_cell_range.generate_range();
-  const auto cells_result = Evaluator::fill_cell_range(range_positions, cells);
-
-  if (std::holds_alternative<std::shared_ptr<ErrorObject>>(cells_result)) {
-    const auto& err = std::get<std::shared_ptr<ErrorObject>>(cells_result);
-    return err;
+                                const Page& page) noexcept -> MytValue {
+  const auto bounds = expr_cell_range.get_range_bounds();
+  if (!bounds) {
+    return MytValue::error(
+        "Wrong type, cell range requires "
+        "`CellRow:CellCol`");
   }
+  const auto [begin, end] = *bounds;
   const auto [lhs_str, rhs_str] = expr_cell_range.get_cells_strs();
-  const auto range_str = lhs_str + ":" + rhs_str;
-  const auto cells_range = &std::get<std::vector<MytObjectPtr>>(cells_result);
-  return std::make_shared<CellRangeObject>(range_str, *cells_range);
+  return Evaluator::get_cell_range_obj(begin, end, lhs_str + ":" + rhs_str,
+                                       page);
 }
 
 auto Evaluator::eval_fn_call(const ExpressionFnCall& expr_fn_call,
-                             const CellMap& cells) noexcept -> MytObjectPtr {
+                             const Page& page) noexcept -> MytValue {
   const auto& ident_expr = expr_fn_call.get_fn_identifier();
   const auto& args_expr = expr_fn_call.get_arguments();
+  const auto& builtin = expr_fn_call.get_builtin();
+  if (builtin && MytBuiltins::get(*builtin).lazy) {
+    return MytBuiltins::call_lazy(
+        *builtin, args_expr.size(), [&](const std::size_t& i) {
+          return Evaluator::evaluate_expression(*args_expr[i], page);
+        });
+  }
 
-  const auto ident_obj = Evaluator::evaluate_expression(ident_expr, cells);
-  if (auto err_obj = DP_CAST_T(ErrorObject, ident_obj)) {
-    return err_obj;
+  // Resolved calls skip materializing the identifier
+  const auto ident = builtin ? MytValue{}
+                             : Evaluator::evaluate_expression(ident_expr, page);
+  if (ident.is_error()) {
+    return ident;
   }
 
-  std::vector<MytObjectPtr> args;
+  MytValueArgs args;
+  args.reserve(args_expr.size());
   for (const auto& arg_expr : args_expr) {
-    args.emplace_back(Evaluator::evaluate_expression(*arg_expr, cells));
+    args.push_back(Evaluator::evaluate_expression(*arg_expr, page));
   }
 
-  if (auto casted_ident_obj = DP_CAST_T(IdentObject, ident_obj)) {
-    const auto value = casted_ident_obj->get_value();
-    return MytBuiltins::exec(value, args);
+  if (builtin) {
+    return MytBuiltins::call(*builtin, args);
+  }
+  if (auto ident_obj = D_CAST(IdentObject, ident.get_object())) {
+    return MytBuiltins::exec(ident_obj->get_value(), args);
   }
 
-  return NOT_IMPL_ERR("Wrong function identifier type: `" +
-                      ident_obj->to_string() + "`");
+  return MytValue::from_object(NOT_IMPL_ERR(
+      "Wrong function identifier type: `" + ident.to_string() + "`"));
 }
@@ -0,0 +1,125 @@
+#include "../../../include/backend/myt_lang/formula.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <variant>
+
+#include "backend/myt_lang/compiler.hpp"
+#include "backend/myt_lang/evaluator.hpp"
+#include "backend/myt_lang/lexer.hpp"
+#include "backend/myt_lang/vm.hpp"
+#include "backend/page.hpp"
+
+namespace {
+// Weak entries, a shape lives as long as some cell holds its formula
+struct InternTable {
+  std::mutex mutex{};
+  std::unordered_map<std::string, std::weak_ptr<const Formula>> shapes{};
+  std::size_t purge_at{64};
+};
+
+auto intern_table() noexcept -> InternTable& {
+  static InternTable table{};
+  return table;
+}
+}  // namespace
+
+Formula::Formula(ParsingResult&& parsed, const std::optional<CellPos>& origin)
+    : m_parsed(std::move(parsed)),
+      m_program(Compiler::compile(m_parsed)),
+      m_origin(origin) {}
+
+auto Formula::compile(const std::string_view& raw_content) noexcept
+    -> FormulaPtr {
+  const auto tokens = Lexer::tokenize_views(raw_content);
+  return std::make_shared<const Formula>(Parser::parse(tokens));
+}
+
+auto Formula::compile(const std::string_view& raw_content,
+                      const CellPos& anchor) noexcept -> FormulaPtr {
+  const auto views = Lexer::tokenize_views(raw_content);
+  const auto key = shape_key(views, anchor);
+  auto& table = intern_table();
+  if (key) {
+    const std::lock_guard<std::mutex> lock{table.mutex};
+    const auto it = table.shapes.find(*key);
+    if (it != table.shapes.cend()) {
+      if (auto interned = it->second.lock()) {
+        return interned;
+      }
+    }
+  }
+
+  auto formula =
+      std::make_shared<const Formula>(Parser::parse(views), anchor);
+  if (!key || !formula->is_shareable()) {
+    return formula;
+  }
+
+  const std::lock_guard<std::mutex> lock{table.mutex};
+  table.shapes[*key] = formula;
+  if (table.shapes.size() >= table.purge_at) {
+    for (auto it = table.shapes.begin(); it != table.shapes.end();) {
+      it = it->second.expired() ? table.shapes.erase(it) : std::next(it);
+    }
+    table.purge_at = std::max<std::size_t>(64, table.shapes.size() * 2);
+  }
+  return formula;
+}
+
+auto Formula::shape_key(const std::vector<TokenView>& tokens,
+                        const CellPos& anchor) noexcept
+    -> std::optional<std::string> {
+  // Text cells show their content as is, moving them must not shift it
+  if (tokens.empty() || tokens.front().type != TokenType::Assign) {
+    return std::nullopt;
+  }
+  std::string key{};
+  for (const auto& token : tokens) {
+    key.push_back(static_cast<char>(token.type));
+    if (token.type != TokenType::CellIdentifier) {
+      key += std::to_string(token.literal.size()) + ":";
+      key += token.literal;
+      continue;
+    }
+    try {
+      const auto offset = CellOffset::between(anchor, CellPos{token.literal});
+      key += "R" + std::to_string(offset.row) + "C" +
+             std::to_string(offset.col);
+    } catch (const InvalidCellString&) {
+      return std::nullopt;
+    }
+  }
+  return key;
+}
+
+auto Formula::is_shareable() const noexcept -> bool {
+  return m_program.has_value() &&
+         std::holds_alternative<ExpressionSharedPtr>(m_parsed);
+}
+
+auto Formula::offset_to(const CellPos& anchor) const noexcept -> CellOffset {
+  if (!m_origin) {
+    return CellOffset{};
+  }
+  return CellOffset::between(*m_origin, anchor);
+}
+
+auto Formula::evaluate(const Page& page) const noexcept -> MytValue {
+  if (m_program) {
+    return Vm::execute(*m_program, page);
+  }
+  return Evaluator::evaluate_value(m_parsed, page);
+}
+
+auto Formula::evaluate(const Page& page, const CellPos& anchor) const noexcept
+    -> MytValue {
+  if (m_program) {
+    return Vm::execute(*m_program, page, offset_to(anchor));
+  }
+  assert(offset_to(anchor).is_zero() && "Tree walked formulas aren't shared");
+  return Evaluator::evaluate_value(m_parsed, page);
+}
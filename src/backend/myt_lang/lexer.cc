@@ -1,7 +1,9 @@
 #include "../../../include/backend/myt_lang/lexer.hpp"
 
-#include <cctype>
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <numeric>
 #include <optional>
@@ -9,54 +11,112 @@
 #include <utility>
 #include <vector>
 
+namespace {
+
+enum CharClass : uint8_t {
+  Whitespace = 1 << 0,
+  Upper = 1 << 1,
+  Lower = 1 << 2,
+  Digit = 1 << 3,
+  Underscore = 1 << 4,
+};
+
+// Classes of every byte, independent of the current locale
+constexpr auto build_char_classes() noexcept -> std::array<uint8_t, 256> {
+  std::array<uint8_t, 256> classes{};
+  for (const auto& c : {' ', '\n', '\t', '\r'}) {
+    classes[static_cast<unsigned char>(c)] = Whitespace;
+  }
+  for (auto c = 'A'; c <= 'Z'; ++c) {
+    classes[static_cast<unsigned char>(c)] = Upper;
+  }
+  for (auto c = 'a'; c <= 'z'; ++c) {
+    classes[static_cast<unsigned char>(c)] = Lower;
+  }
+  for (auto c = '0'; c <= '9'; ++c) {
+    classes[static_cast<unsigned char>(c)] = Digit;
+  }
+  classes[static_cast<unsigned char>('_')] = Underscore;
+  return classes;
+}
+
+constexpr auto char_classes = build_char_classes();
+
+constexpr auto has_class(const char& c, const uint8_t& classes) noexcept
+    -> bool {
+  return (char_classes[static_cast<unsigned char>(c)] & classes) != 0;
+}
+
+}  // namespace
+
 auto Lexer::tokenize(const std::string_view& raw_content) noexcept
     -> std::vector<Token> {
-  const auto not_qoute = [](const char& c) { return c != '\"'; };
+  std::vector<TokenView> views{};
+  tokenize_views(raw_content, views);
 
   std::vector<Token> tokens{};
-  auto i = raw_content.begin();
-  while (i < raw_content.end()) {
-    if (is_whitespace(*i)) {
-      i++;
-      continue;
-    } else if (auto single_char_tok = Lexer::get_sign_token(raw_content, i)) {
-      tokens.emplace_back(*single_char_tok);
-    } else if (*i == '\"') {
-      i++;
-      if (auto str = Lexer::read_forward_if(raw_content, i, not_qoute)) {
-        tokens.emplace_back(Token{TokenType::String, std::string(*str)});
-      }
+  tokens.reserve(views.size());
+  for (const auto& view : views) {
+    tokens.push_back(view.to_token());
+  }
+  return tokens;
+}
+
+auto Lexer::tokenize_views(const std::string_view& raw_content) noexcept
+    -> std::vector<TokenView> {
+  std::vector<TokenView> tokens{};
+  tokenize_views(raw_content, tokens);
+  return tokens;
+}
+
+auto Lexer::tokenize_views(const std::string_view& raw_content,
+                           std::vector<TokenView>& tokens) noexcept -> void {
+  const auto push = [&](const TokenType& type, const std::size_t& start,
+                        const std::size_t& len) {
+    tokens.push_back(TokenView{type, raw_content.substr(start, len)});
+  };
+
+  tokens.clear();
+  std::size_t i{0};
+  while (i < raw_content.size()) {
+    const auto c = raw_content[i];
+    std::size_t len{0};
+    if (is_whitespace(c)) {
       i++;
-    } else if (auto cell_ident = Lexer::read_cell_indent(raw_content, i)) {
-      const auto token_value = std::string(*cell_ident);
-      const auto token = Token{TokenType::CellIdentifier, token_value};
-      tokens.emplace_back(token);
-    } else if (auto ident = Lexer::read_forward_if(raw_content, i,
-                                                   Lexer::is_identifier_char)) {
-      if (auto keywordType =
-              Lexer::get_token_type_keyword(std::string(*ident))) {
-        const auto token = Token{*keywordType, std::string(*ident)};
-        tokens.emplace_back(token);
-      } else {
-        const auto token = Token{TokenType::Identifier, std::string(*ident)};
-        tokens.emplace_back(token);
+    } else if (auto sign_tok = Lexer::get_sign_token(raw_content, i)) {
+      tokens.push_back(*sign_tok);
+      i += sign_tok->literal.size();
+    } else if (c == '\"') {
+      // An unterminated string runs until the end of the cell
+      const auto close = std::min(raw_content.find('\"', i + 1),
+                                  raw_content.size());
+      if (close > i + 1) {
+        push(TokenType::String, i + 1, close - i - 1);
       }
-    } else if (auto float_num = Lexer::read_float(raw_content, i)) {
-      const auto token = Token{TokenType::Float, std::string(*float_num)};
-      tokens.emplace_back(token);
-    } else if (auto num =
-                   Lexer::read_forward_if(raw_content, i, Lexer::is_numeric)) {
-      const auto token = Token{TokenType::Int, std::string(*num)};
-      tokens.emplace_back(token);
+      i = close + 1;
+    } else if ((len = Lexer::read_cell_indent(raw_content, i)) > 0) {
+      push(TokenType::CellIdentifier, i, len);
+      i += len;
+    } else if ((len = Lexer::read_forward_if(
+                    raw_content, i, Lexer::is_identifier_char)) > 0) {
+      const auto ident = raw_content.substr(i, len);
+      const auto keyword_type = Lexer::get_token_type_keyword(ident);
+      push(keyword_type.value_or(TokenType::Identifier), i, len);
+      i += len;
+    } else if ((len = Lexer::read_float(raw_content, i)) > 0) {
+      push(TokenType::Float, i, len);
+      i += len;
+    } else if ((len = Lexer::read_forward_if(raw_content, i,
+                                             Lexer::is_numeric)) > 0) {
+      push(TokenType::Int, i, len);
+      i += len;
     } else {
-      const auto token = Token{TokenType::Illegal, "Illegal"};
-      tokens.emplace_back(token);
+      tokens.push_back(TokenView{TokenType::Illegal, "Illegal"});
+      i++;
     }
-    i++;
   }
 
-  tokens.emplace_back(Token{TokenType::EndOfCell, "EOC"});
-  return tokens;
+  tokens.push_back(TokenView{TokenType::EndOfCell, "EOC"});
 }
 
 auto Lexer::tokens_to_string(const std::vector<Token>& tokens) noexcept
@@ -70,156 +130,107 @@ auto Lexer::tokens_to_string(const std::vector<Token>& tokens) noexcept
                          std::string(tokens[0]), new_line_fold);
 }
 
-constexpr inline auto Lexer::is_whitespace(const char& c) noexcept -> bool {
-  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+auto Lexer::is_whitespace(const char& c) noexcept -> bool {
+  return has_class(c, Whitespace);
 }
 
-constexpr inline auto Lexer::is_identifier_char(const char& c) noexcept
-    -> bool {
-  return std::isalpha(c) || c == '_';
+auto Lexer::is_identifier_char(const char& c) noexcept -> bool {
+  return has_class(c, Upper | Lower | Underscore);
 }
 
-constexpr inline auto Lexer::is_cell_identifier_char(const char& c) noexcept
-    -> bool {
-  return std::isalpha(c) && std::isupper(c);
+auto Lexer::is_cell_identifier_char(const char& c) noexcept -> bool {
+  return has_class(c, Upper);
 }
 
-constexpr inline auto Lexer::is_numeric(const char& c) noexcept -> bool {
-  return std::isdigit(c);
+auto Lexer::is_numeric(const char& c) noexcept -> bool {
+  return has_class(c, Digit);
 }
 
 auto Lexer::get_sign_token(const std::string_view& content,
-                           std::string_view::iterator& cur) noexcept
-    -> std::optional<Token> {
-  switch (*cur) {
+                           const std::size_t& cur) noexcept
+    -> std::optional<TokenView> {
+  const auto next_is_eq = cur + 1 < content.size() && content[cur + 1] == '=';
+  const auto sign = [&](const TokenType& type, const std::size_t& len) {
+    return TokenView{type, content.substr(cur, len)};
+  };
+  switch (content[cur]) {
     case '=':
-      if (cur + 1 != content.end() && *(cur + 1) == '=') {
-        cur++;
-        return Token{TokenType::Eq, "=="};
-      }
-      return Token{TokenType::Assign, "="};
+      return next_is_eq ? sign(TokenType::Eq, 2) : sign(TokenType::Assign, 1);
     case '!':
-      if (cur + 1 != content.end() && *(cur + 1) == '=') {
-        cur++;
-        return Token{TokenType::NotEq, "!="};
-      }
-      return Token{TokenType::Bang, "!"};
+      return next_is_eq ? sign(TokenType::NotEq, 2) : sign(TokenType::Bang, 1);
     case '+':
-      return Token{TokenType::Plus, "+"};
+      return sign(TokenType::Plus, 1);
     case '-':
-      return Token{TokenType::Minus, "-"};
+      return sign(TokenType::Minus, 1);
     case '*':
-      return Token{TokenType::Asterisk, "*"};
+      return sign(TokenType::Asterisk, 1);
     case '/':
-      return Token{TokenType::Slash, "/"};
+      return sign(TokenType::Slash, 1);
     case ',':
-      return Token{TokenType::Comma, ","};
+      return sign(TokenType::Comma, 1);
     case ':':
-      return Token{TokenType::Colon, ":"};
+      return sign(TokenType::Colon, 1);
     case '(':
-      return Token{TokenType::LParen, "("};
+      return sign(TokenType::LParen, 1);
     case ')':
-      return Token{TokenType::RParen, ")"};
+      return sign(TokenType::RParen, 1);
     case '>':
-      if (cur + 1 != content.end() && *(cur + 1) == '=') {
-        cur++;
-        return Token{TokenType::Ge, ">="};
-      }
-      return Token{TokenType::Gt, ">"};
+      return next_is_eq ? sign(TokenType::Ge, 2) : sign(TokenType::Gt, 1);
     case '<':
-      if (cur + 1 != content.end() && *(cur + 1) == '=') {
-        cur++;
-        return Token{TokenType::Le, "<="};
-      }
-      return Token{TokenType::Lt, "<"};
-  }
-  return std::nullopt;
-}
-
-auto Lexer::read_forward_if(const std::string_view& content,
-                            std::string_view::iterator& cur_it,
-                            const Condition& cond) noexcept
-    -> std::optional<std::string_view> {
-  auto start = cur_it;
-  std::size_t len{0};
-  while (cur_it != content.end() && cond(*cur_it)) {
-    len++;
-    cur_it++;
-  }
-  if (len > 0) {
-    cur_it--;
-    return std::string_view{start, len};
+      return next_is_eq ? sign(TokenType::Le, 2) : sign(TokenType::Lt, 1);
   }
   return std::nullopt;
 }
 
 auto Lexer::read_cell_indent(const std::string_view& content,
-                             std::string_view::iterator& cur_it) noexcept
-    -> std::optional<std::string_view> {
+                             const std::size_t& cur) noexcept -> std::size_t {
   bool started_letter_idx{false}, started_number_idx{false};
 
-  const auto start = cur_it;
-  auto it = cur_it;
-  constexpr auto char_or_num = [](const auto& c) {
-    return Lexer::is_cell_identifier_char(c) || Lexer::is_numeric(c);
-  };
-
-  for (; it != content.end() && char_or_num(*it); ++it) {
-    if (Lexer::is_cell_identifier_char(*it)) {
+  auto it = cur;
+  for (; it < content.size() && has_class(content[it], Upper | Digit); ++it) {
+    if (Lexer::is_cell_identifier_char(content[it])) {
       if (started_number_idx)
-        return std::nullopt;
+        return 0;
       else if (!started_letter_idx)
         started_letter_idx = true;
     } else {
       if (!started_letter_idx)
-        return std::nullopt;
+        return 0;
       else if (!started_number_idx) {
-        if (*it == '0') return std::nullopt;
+        if (content[it] == '0') return 0;
         started_number_idx = true;
       }
     }
   }
   if (started_letter_idx && started_number_idx) {
-    auto len = static_cast<std::size_t>(it - start);
-    cur_it = --it;
-    return std::string_view{start, len};
+    return it - cur;
   }
-  return std::nullopt;
+  return 0;
 }
 
 auto Lexer::read_float(const std::string_view& content,
-                       std::string_view::iterator& cur_it) noexcept
-    -> std::optional<std::string_view> {
-  const auto start = cur_it;
-  auto it = cur_it;
+                       const std::size_t& cur) noexcept -> std::size_t {
+  auto it = cur;
   bool seen_dot{false};
   bool seen_num{false};
-  const auto num_or_point = [](const auto& c) {
-    return Lexer::is_numeric(c) || c == '.';
-  };
 
-  for (; it != content.end() && num_or_point(*it); ++it) {
-    if (*it == '.') {
-      if (seen_dot) return std::nullopt;
+  for (; it < content.size() && (is_numeric(content[it]) || content[it] == '.');
+       ++it) {
+    if (content[it] == '.') {
+      if (seen_dot) return 0;
       seen_dot = true;
-    } else if (is_numeric(*it)) {
+    } else {
       seen_num = true;
     }
   }
-  if (!seen_dot || !seen_num) return std::nullopt;
-
-  auto len = static_cast<std::size_t>(it - start);
-  cur_it = --it;
-  return std::string_view{start, len};
-}
-
-auto Lexer::is_keyword(const std::string& ident) noexcept -> bool {
-  return TokenUtils::keywordsLookup.find(ident) !=
-         TokenUtils::keywordsLookup.end();
+  if (!seen_dot || !seen_num) return 0;
+  return it - cur;
 }
 
-auto Lexer::get_token_type_keyword(const std::string& ident) noexcept
+auto Lexer::get_token_type_keyword(const std::string_view& ident) noexcept
     -> std::optional<TokenType> {
-  if (!is_keyword(ident)) return std::nullopt;
-  return TokenUtils::keywordsLookup.at(ident);
+  for (const auto& [keyword, type] : TokenUtils::keywords) {
+    if (keyword == ident) return type;
+  }
+  return std::nullopt;
 }
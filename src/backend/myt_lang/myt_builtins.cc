@@ -3,95 +3,147 @@
 #include <cmath>
 #include <memory>
 
+#include "backend/myt_lang/aggregate.hpp"
 #include "backend/myt_lang/ast.hpp"
 #include "backend/myt_lang/myt_object.hpp"
+#include "backend/myt_lang/myt_value.hpp"
 
 #define MYT_PI 3.141592653589793238462643383279502884197
 
+static_assert(MytBuiltins::get(BuiltinId::Pi).id == BuiltinId::Pi &&
+                  MytBuiltins::get(BuiltinId::Sqrt).id == BuiltinId::Sqrt &&
+                  MytBuiltins::get(BuiltinId::Sum).id == BuiltinId::Sum &&
+                  MytBuiltins::get(BuiltinId::Avg).id == BuiltinId::Avg &&
+                  MytBuiltins::get(BuiltinId::Min).id == BuiltinId::Min &&
+                  MytBuiltins::get(BuiltinId::Max).id == BuiltinId::Max &&
+                  MytBuiltins::get(BuiltinId::Count).id == BuiltinId::Count &&
+                  MytBuiltins::get(BuiltinId::Product).id ==
+                      BuiltinId::Product &&
+                  MytBuiltins::get(BuiltinId::If).id == BuiltinId::If &&
+                  MytBuiltins::get(BuiltinId::And).id == BuiltinId::And &&
+                  MytBuiltins::get(BuiltinId::Or).id == BuiltinId::Or &&
+                  MytBuiltins::get(BuiltinId::IfError).id ==
+                      BuiltinId::IfError &&
+                  MytBuiltins::get(BuiltinId::Choose).id == BuiltinId::Choose,
+              "Registry has to be ordered by `BuiltinId`");
+static_assert(MytBuiltins::find("Sqrt") == BuiltinId::Sqrt);
+
+auto MytBuiltins::check_arity(const BuiltinId& id,
+                              const std::size_t& argc) noexcept
+    -> std::optional<std::string> {
+  const auto& builtin = get(id);
+  if (argc >= builtin.min_args && argc <= builtin.max_args) {
+    return std::nullopt;
+  }
+  const auto n_want = builtin.max_args == VARIADIC
+                          ? "More than " + std::to_string(builtin.min_args - 1)
+                          : std::to_string(builtin.min_args);
+  return "Function: `" + std::string(builtin.name) + "` takes: " + n_want +
+         " arguments, got: " + std::to_string(argc);
+}
+
+auto MytBuiltins::call(const BuiltinId& id, const MytValueArgs& args) noexcept
+    -> MytValue {
+  if (auto arity_err = check_arity(id, args.size())) {
+    return MytValue::error(*arity_err);
+  }
+  const auto& builtin = get(id);
+  if (builtin.lazy) {
+    return call_lazy(id, args.size(),
+                     [&args](const std::size_t& i) { return args[i]; });
+  }
+  if (builtin.arg_type == ArgType::Number) {
+    for (const auto& arg : args) {
+      if (!arg.is_numeric()) {
+        return WRONG_TYPE_ERR(builtin.name, "int/float", arg.to_string());
+      }
+    }
+  }
+  return builtin.fn(args);
+}
+
 auto MytBuiltins::exec(const std::string& fn_name,
-                       const MytObjectArgs& args) noexcept -> MytObjectPtr {
-  if (!MytBuiltins::is_in_builtins(fn_name)) {
-    return std::make_shared<ErrorObject>("No function named: `" + fn_name +
-                                         "`");
+                       const MytValueArgs& args) noexcept -> MytValue {
+  const auto id = find(fn_name);
+  if (!id) {
+    return MytValue::error("No function named: `" + fn_name + "`");
   }
-  return MytBuiltins::BuiltinFns.at(fn_name)(args);
+  return call(*id, args);
 }
 
-// NO ARGS
+auto MytBuiltins::to_condition(const BuiltinId& id,
+                               const MytValue& value) noexcept -> MytValue {
+  switch (value.tag()) {
+    case MytValue::Tag::Bool:
+      return value;
+    case MytValue::Tag::Nil:
+      return MytValue::from_bool(false);
+    case MytValue::Tag::Int:
+    case MytValue::Tag::Float:
+      return MytValue::from_bool(value.get_number() != 0);
+    default:
+      if (value.is_error()) {
+        return value;
+      }
+      return WRONG_TYPE_ERR(get(id).name, "bool", value.to_string());
+  }
+}
 
-auto MytBuiltins::m_pi([[maybe_unused]] const MytObjectArgs& args) noexcept
-    -> MytObjectPtr {
-  if (!args.empty()) {
-    return N_ARGS_ERR("Pi", 0, args.size());
+auto MytBuiltins::to_choice(const MytValue& index,
+                            const std::size_t& n_choices) noexcept
+    -> MytValue {
+  if (index.is_error()) {
+    return index;
   }
+  if (!index.is_numeric()) {
+    return WRONG_TYPE_ERR("Choose", "int/float", index.to_string());
+  }
+  const auto choice = std::trunc(index.get_number());
+  if (choice < 1 || choice > static_cast<double>(n_choices)) {
+    return MytValue::error("Choose index: " + index.to_string() +
+                           " out of range: [1, " + std::to_string(n_choices) +
+                           "]");
+  }
+  return MytValue::from_int(static_cast<int>(choice));
+}
+
+// NO ARGS
+
+auto MytBuiltins::m_pi([[maybe_unused]] const MytValueArgs& args) noexcept
+    -> MytValue {
   constexpr auto ret_pi = static_cast<FloatType>(MYT_PI);
-  return std::make_shared<ValueObject<FloatType>>(ret_pi);
+  return MytValue::from_float(ret_pi);
 }
 
 // ONE ARG
 
-auto MytBuiltins::m_sqrt(const MytObjectArgs& args) noexcept -> MytObjectPtr {
-  if (args.size() != 1) {
-    return N_ARGS_ERR("Pi", 1, args.size());
-  }
-  constexpr auto exec_sqrt = [](const auto& v) {
-    const auto value_double = static_cast<double>(v);
-    const auto sqrt_double = std::sqrt(value_double);
-    const auto ret_float = static_cast<FloatType>(sqrt_double);
-    return MS_VO_T(FloatType, ret_float);
-  };
-
-  if (auto int_obj = DP_CAST_VO_T(int, args[0])) {
-    return exec_sqrt(int_obj->get_value());
-  } else if (auto float_obj = DP_CAST_VO_T(FloatType, args[0])) {
-    return exec_sqrt(float_obj->get_value());
-  }
-  return WRONG_TYPE_ERR("sqrt", "int/float", args[0]->to_string());
+auto MytBuiltins::m_sqrt(const MytValueArgs& args) noexcept -> MytValue {
+  const auto sqrt_double = std::sqrt(args[0].get_number());
+  return MytValue::from_float(static_cast<FloatType>(sqrt_double));
 }
 
 // MANY ARGS
 
-auto MytBuiltins::m_sum(const MytObjectArgs& args) noexcept -> MytObjectPtr {
-  if (args.size() == 0) {
-    return N_STR_ARGS_ERR("Sum", "More than 0", args.size());
-  }
-  int sumi{};
-  FloatType sumf{};
-  auto seen_float{false};
-
-  for (const auto& arg : args) {
-    if (!seen_float) {
-      if (auto int_obj = DP_CAST_VO_T(int, arg)) {
-        sumi += int_obj->get_value();
-      } else if (auto float_obj = DP_CAST_VO_T(FloatType, arg)) {
-        seen_float = true;
-        sumf = float_obj->get_value() + static_cast<FloatType>(sumi);
-      } else if (auto range_obj = DP_CAST_T(CellRangeObject, arg)) {
-        auto res = MytBuiltins::m_sum(range_obj->get_cells_range());
-        if (auto int_res = DP_CAST_VO_T(int, res)) {
-          sumi += int_res->get_value();
-        } else if (auto float_res = DP_CAST_VO_T(FloatType, res)) {
-          seen_float = true;
-          sumf = float_res->get_value() + static_cast<FloatType>(sumi);
-        }
-      }
-    } else {
-      if (auto int_obj = DP_CAST_VO_T(int, arg)) {
-        sumf += static_cast<FloatType>(int_obj->get_value());
-      } else if (auto float_obj = DP_CAST_VO_T(FloatType, arg)) {
-        sumf += float_obj->get_value();
-      } else if (auto range_obj = DP_CAST_T(CellRangeObject, arg)) {
-        auto res = MytBuiltins::m_sum(range_obj->get_cells_range());
-        if (auto int_res = DP_CAST_VO_T(int, res)) {
-          sumf += static_cast<FloatType>(int_res->get_value());
-        } else if (auto float_res = DP_CAST_VO_T(FloatType, res)) {
-          sumf += float_res->get_value();
-        }
-      }
-    }
-  }
-  if (seen_float) {
-    return MS_VO_T(FloatType, sumf);
-  }
-  return MS_VO_T(int, sumi);
+auto MytBuiltins::m_sum(const MytValueArgs& args) noexcept -> MytValue {
+  return Aggregate::fold(Aggregate::Op::Sum, args);
+}
+
+auto MytBuiltins::m_avg(const MytValueArgs& args) noexcept -> MytValue {
+  return Aggregate::fold(Aggregate::Op::Avg, args);
+}
+
+auto MytBuiltins::m_min(const MytValueArgs& args) noexcept -> MytValue {
+  return Aggregate::fold(Aggregate::Op::Min, args);
+}
+
+auto MytBuiltins::m_max(const MytValueArgs& args) noexcept -> MytValue {
+  return Aggregate::fold(Aggregate::Op::Max, args);
+}
+
+auto MytBuiltins::m_count(const MytValueArgs& args) noexcept -> MytValue {
+  return Aggregate::fold(Aggregate::Op::Count, args);
+}
+
+auto MytBuiltins::m_product(const MytValueArgs& args) noexcept -> MytValue {
+  return Aggregate::fold(Aggregate::Op::Product, args);
 }
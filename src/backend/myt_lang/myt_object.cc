@@ -1 +1,187 @@
 #include "../../../include/backend/myt_lang/myt_object.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "backend/myt_lang/element_wise.hpp"
+#include "backend/page.hpp"
+
+auto CellRangeObject::to_string() const noexcept -> const std::string {
+  std::string cells{};
+  for (const auto& value : get_values()) {
+    cells += (cells.empty() ? "" : "; ") + value.to_string();
+  }
+  return m_range_str + " ( " + cells + " )";
+}
+
+auto CellRangeObject::equals(const MytObject& other) const noexcept -> bool {
+  const auto range = D_CAST(CellRangeObject, &other);
+  return range != nullptr && range->m_range_str == m_range_str &&
+         range->get_values() == get_values();
+}
+
+auto CellRangeObject::add(MytObjectPtr other) const noexcept -> MytObjectPtr {
+  return ElementWise::apply(BinaryOp::Add, ArrayObject{*this},
+                            MytValue::from_object(other))
+      .to_object();
+}
+
+auto CellRangeObject::sub(MytObjectPtr other) const noexcept -> MytObjectPtr {
+  return ElementWise::apply(BinaryOp::Sub, ArrayObject{*this},
+                            MytValue::from_object(other))
+      .to_object();
+}
+
+auto CellRangeObject::mul(MytObjectPtr other) const noexcept -> MytObjectPtr {
+  return ElementWise::apply(BinaryOp::Mul, ArrayObject{*this},
+                            MytValue::from_object(other))
+      .to_object();
+}
+
+auto CellRangeObject::div(MytObjectPtr other) const noexcept -> MytObjectPtr {
+  return ElementWise::apply(BinaryOp::Div, ArrayObject{*this},
+                            MytValue::from_object(other))
+      .to_object();
+}
+
+auto CellRangeObject::detach(MytValue value) noexcept -> MytValue {
+  const auto range = D_CAST(CellRangeObject, value.get_object());
+  if (range == nullptr || !range->is_view()) {
+    return value;
+  }
+  auto cells_range = range->get_values();
+  for (const auto& cell_value : cells_range) {
+    if (ElementWise::is_array(cell_value)) {
+      return MytValue::error(
+          "Invalid expression: nested cell ranges are not supported yet");
+    }
+  }
+  return MytValue::from_object(std::make_shared<CellRangeObject>(
+      range->m_range_str, std::move(cells_range)));
+}
+
+auto CellRangeObject::size() const noexcept -> std::size_t {
+  if (!is_view()) {
+    return m_cells_range.size();
+  }
+  if (m_begin.col > m_end.col || m_begin.row > m_end.row) {
+    return 0;
+  }
+  const auto cols = static_cast<std::size_t>(m_end.col - m_begin.col) + 1;
+  const auto rows = static_cast<std::size_t>(m_end.row - m_begin.row) + 1;
+  return cols * rows;
+}
+
+auto CellRangeObject::get_values() const noexcept -> std::vector<MytValue> {
+  if (!is_view()) {
+    return m_cells_range;
+  }
+  std::vector<MytValue> values(size());
+  for_each_occupied([&values](const std::size_t& idx, const MytValue& value) {
+    values[idx] = value;
+  });
+  return values;
+}
+
+ArrayObject::ArrayObject(const std::vector<MytValue>& values)
+    : ArrayObject(values.size()) {
+  for (std::size_t i{0}; i < values.size(); ++i) {
+    set(i, values[i]);
+  }
+}
+
+ArrayObject::ArrayObject(const CellRangeObject& range)
+    : ArrayObject(range.size()) {
+  range.for_each_occupied([this](const std::size_t& idx,
+                                 const MytValue& value) { set(idx, value); });
+}
+
+auto ArrayObject::to_string() const noexcept -> const std::string {
+  std::string result{"{ "};
+  for (std::size_t i{0}; i < size(); ++i) {
+    if (i > 0) {
+      result += "; ";
+    }
+    result += get(i).to_string();
+  }
+  return result + " }";
+}
+
+auto ArrayObject::equals(const MytObject& other) const noexcept -> bool {
+  const auto array = D_CAST(ArrayObject, &other);
+  if (array == nullptr || array->m_kinds != m_kinds) {
+    return false;
+  }
+  for (std::size_t i{0}; i < size(); ++i) {
+    const auto same = (m_kinds[i] == Kind::Other)
+                          ? array->get(i) == get(i)
+                          : MytValue::same_number(array->m_numbers[i],
+                                                  m_numbers[i]);
+    if (!same) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ArrayObject::add(MytObjectPtr other) const noexcept -> MytObjectPtr {
+  return ElementWise::apply(BinaryOp::Add, *this, MytValue::from_object(other))
+      .to_object();
+}
+
+auto ArrayObject::sub(MytObjectPtr other) const noexcept -> MytObjectPtr {
+  return ElementWise::apply(BinaryOp::Sub, *this, MytValue::from_object(other))
+      .to_object();
+}
+
+auto ArrayObject::mul(MytObjectPtr other) const noexcept -> MytObjectPtr {
+  return ElementWise::apply(BinaryOp::Mul, *this, MytValue::from_object(other))
+      .to_object();
+}
+
+auto ArrayObject::div(MytObjectPtr other) const noexcept -> MytObjectPtr {
+  return ElementWise::apply(BinaryOp::Div, *this, MytValue::from_object(other))
+      .to_object();
+}
+
+auto ArrayObject::get(const std::size_t& idx) const noexcept -> MytValue {
+  switch (m_kinds[idx]) {
+    case Kind::Int:
+      return MytValue::from_int(static_cast<int>(m_numbers[idx]));
+    case Kind::Float:
+      return MytValue::from_float(static_cast<FloatType>(m_numbers[idx]));
+    case Kind::Bool:
+      return MytValue::from_bool(m_numbers[idx] != 0.0);
+    case Kind::Other:
+      break;
+  }
+  const auto it = m_others.find(idx);
+  return (it != m_others.cend()) ? it->second : MytValue{};
+}
+
+auto ArrayObject::set(const std::size_t& idx, const MytValue& value) noexcept
+    -> void {
+  m_others.erase(idx);
+  switch (value.tag()) {
+    case MytValue::Tag::Int:
+    case MytValue::Tag::Float:
+      m_numbers[idx] = value.get_number();
+      m_kinds[idx] = (value.tag() == MytValue::Tag::Int) ? Kind::Int
+                                                         : Kind::Float;
+      return;
+    case MytValue::Tag::Bool:
+      m_numbers[idx] = value.get_bool() ? 1.0 : 0.0;
+      m_kinds[idx] = Kind::Bool;
+      return;
+    case MytValue::Tag::Nil:
+      m_numbers[idx] = 0.0;
+      m_kinds[idx] = Kind::Other;
+      return;
+    case MytValue::Tag::Object:
+      m_numbers[idx] = 0.0;
+      m_kinds[idx] = Kind::Other;
+      m_others.insert_or_assign(idx, value);
+      return;
+  }
+}
@@ -0,0 +1,315 @@
+#include "../../../include/backend/myt_lang/myt_value.hpp"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "backend/myt_lang/element_wise.hpp"
+#include "backend/myt_lang/myt_object.hpp"
+
+namespace {
+
+// Int results out of the `int` range become floats instead of overflowing,
+// the same as in `ElementWise` lanes
+template <typename Fn>
+auto numeric_operation(const MytValue& lhs,
+                       const MytValue& rhs,
+                       Fn&& op) noexcept -> MytValue {
+  using Tag = MytValue::Tag;
+  const auto as_float = [](const MytValue& v) {
+    return (v.tag() == Tag::Int) ? static_cast<FloatType>(v.get_int())
+                                 : v.get_float();
+  };
+  if (lhs.tag() == Tag::Int && rhs.tag() == Tag::Int) {
+    const auto wide = op(int64_t{lhs.get_int()}, int64_t{rhs.get_int()});
+    if (wide >= std::numeric_limits<int>::min() &&
+        wide <= std::numeric_limits<int>::max()) {
+      return MytValue::from_int(static_cast<int>(wide));
+    }
+  }
+  return MytValue::from_float(op(as_float(lhs), as_float(rhs)));
+}
+
+template <typename T>
+auto compare_ordered(const BinaryOp& op, const T& lhs, const T& rhs) noexcept
+    -> bool {
+  switch (op) {
+    case BinaryOp::Eq:
+      return lhs == rhs;
+    case BinaryOp::NotEq:
+      return lhs != rhs;
+    case BinaryOp::Gt:
+      return lhs > rhs;
+    case BinaryOp::Ge:
+      return lhs >= rhs;
+    case BinaryOp::Lt:
+      return lhs < rhs;
+    default:
+      return lhs <= rhs;
+  }
+}
+
+auto op_literal(const BinaryOp& op) noexcept -> std::string {
+  switch (op) {
+    case BinaryOp::Add:
+      return "+";
+    case BinaryOp::Sub:
+      return "-";
+    case BinaryOp::Mul:
+      return "*";
+    case BinaryOp::Div:
+      return "/";
+    case BinaryOp::Eq:
+      return "==";
+    case BinaryOp::NotEq:
+      return "!=";
+    case BinaryOp::Gt:
+      return ">";
+    case BinaryOp::Ge:
+      return ">=";
+    case BinaryOp::Lt:
+      return "<";
+    case BinaryOp::Le:
+      return "<=";
+  }
+  return "";
+}
+
+// Guards the first and last `MytValue` of an object taking and dropping its
+// `m_self`, striped by address so unrelated objects rarely wait on each other
+auto object_mutex(const MytObject* object) noexcept -> std::mutex& {
+  static std::array<std::mutex, 64> mutexes{};
+  const auto address = reinterpret_cast<std::uintptr_t>(object);
+  return mutexes[address / alignof(std::max_align_t) % mutexes.size()];
+}
+
+}  // namespace
+
+auto MytValue::from_object(const MytObjectPtr& obj) noexcept -> MytValue {
+  if (const auto int_obj = D_CAST(ValueObject<int>, obj.get())) {
+    return MytValue::from_int(int_obj->get_value());
+  } else if (const auto float_obj = D_CAST(ValueObject<FloatType>, obj.get())) {
+    return MytValue::from_float(float_obj->get_value());
+  } else if (const auto bool_obj = D_CAST(ValueObject<bool>, obj.get())) {
+    return MytValue::from_bool(bool_obj->get_value());
+  } else if (obj == nullptr || D_CAST(NilObject, obj.get())) {
+    return MytValue{};
+  }
+  auto result = MytValue{};
+  result.m_tag = Tag::Object;
+  result.m_payload.object = obj.get();
+  // Values already sharing the object only bump its count, the first one
+  // takes the ownership of `m_self` under the lock of the last one dropping it
+  auto& refs = obj->m_value_refs;
+  auto count = refs.load(std::memory_order_relaxed);
+  while (count > 0) {
+    if (refs.compare_exchange_weak(count, count + 1,
+                                   std::memory_order_relaxed)) {
+      return result;
+    }
+  }
+  const std::lock_guard<std::mutex> lock{object_mutex(obj.get())};
+  if (refs.fetch_add(1, std::memory_order_relaxed) == 0) {
+    obj->m_self = obj;
+  }
+  return result;
+}
+
+auto MytValue::retain_object(const MytObject* object) noexcept -> void {
+  object->m_value_refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto MytValue::release_object(const MytObject* object) noexcept -> void {
+  auto& refs = object->m_value_refs;
+  auto count = refs.load(std::memory_order_relaxed);
+  while (count > 1) {
+    if (refs.compare_exchange_weak(count, count - 1,
+                                   std::memory_order_acq_rel,
+                                   std::memory_order_relaxed)) {
+      return;
+    }
+  }
+  // Destroyed once the lock is released, `object` may own other values
+  MytObjectPtr last{};
+  {
+    const std::lock_guard<std::mutex> lock{object_mutex(object)};
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      last = std::move(object->m_self);
+    }
+  }
+}
+
+auto MytValue::error(const std::string& msg) noexcept -> MytValue {
+  return MytValue::from_object(MS_T(ErrorObject, msg));
+}
+
+auto MytValue::is_error() const noexcept -> bool {
+  return D_CAST(ErrorObject, get_object()) != nullptr;
+}
+
+auto MytValue::to_object() const noexcept -> MytObjectPtr {
+  switch (m_tag) {
+    case Tag::Nil:
+      return MS_T(NilObject, );
+    case Tag::Int:
+      return MS_VO_T(int, m_payload.int_value);
+    case Tag::Float:
+      return MS_VO_T(FloatType, m_payload.float_value);
+    case Tag::Bool:
+      return MS_VO_T(bool, m_payload.bool_value);
+    case Tag::Object:
+      return m_payload.object->m_self;
+  }
+  return MS_T(NilObject, );
+}
+
+auto MytValue::to_string() const noexcept -> std::string {
+  switch (m_tag) {
+    case Tag::Nil:
+      return "Nil";
+    case Tag::Int:
+      return std::to_string(m_payload.int_value);
+    case Tag::Float:
+      return std::to_string(m_payload.float_value);
+    case Tag::Bool:
+      return m_payload.bool_value ? "true" : "false";
+    case Tag::Object:
+      return m_payload.object->to_string();
+  }
+  return "";
+}
+
+auto MytValue::operator==(const MytValue& other) const noexcept -> bool {
+  if (m_tag != other.m_tag) {
+    return false;
+  }
+  switch (m_tag) {
+    case Tag::Nil:
+      return true;
+    case Tag::Int:
+      return m_payload.int_value == other.m_payload.int_value;
+    case Tag::Float:
+      return MytValue::same_number(m_payload.float_value,
+                                   other.m_payload.float_value);
+    case Tag::Bool:
+      return m_payload.bool_value == other.m_payload.bool_value;
+    case Tag::Object:
+      return m_payload.object == other.m_payload.object ||
+             m_payload.object->equals(*other.m_payload.object);
+  }
+  return false;
+}
+
+auto MytValue::same_number(const double& lhs, const double& rhs) noexcept
+    -> bool {
+  return lhs == rhs && std::signbit(lhs) == std::signbit(rhs);
+}
+
+auto MytValue::add(const MytValue& lhs, const MytValue& rhs) noexcept
+    -> MytValue {
+  if (lhs.is_numeric() && rhs.is_numeric()) {
+    return numeric_operation(
+        lhs, rhs, [](const auto& a, const auto& b) { return a + b; });
+  }
+  if (ElementWise::is_array(lhs) || ElementWise::is_array(rhs)) {
+    return ElementWise::apply(BinaryOp::Add, lhs, rhs);
+  }
+  return MytValue::from_object(lhs.to_object()->add(rhs.to_object()));
+}
+
+auto MytValue::sub(const MytValue& lhs, const MytValue& rhs) noexcept
+    -> MytValue {
+  if (lhs.is_numeric() && rhs.is_numeric()) {
+    return numeric_operation(
+        lhs, rhs, [](const auto& a, const auto& b) { return a - b; });
+  }
+  if (ElementWise::is_array(lhs) || ElementWise::is_array(rhs)) {
+    return ElementWise::apply(BinaryOp::Sub, lhs, rhs);
+  }
+  return MytValue::from_object(lhs.to_object()->sub(rhs.to_object()));
+}
+
+auto MytValue::mul(const MytValue& lhs, const MytValue& rhs) noexcept
+    -> MytValue {
+  if (lhs.is_numeric() && rhs.is_numeric()) {
+    return numeric_operation(
+        lhs, rhs, [](const auto& a, const auto& b) { return a * b; });
+  }
+  if (ElementWise::is_array(lhs) || ElementWise::is_array(rhs)) {
+    return ElementWise::apply(BinaryOp::Mul, lhs, rhs);
+  }
+  return MytValue::from_object(lhs.to_object()->mul(rhs.to_object()));
+}
+
+auto MytValue::div(const MytValue& lhs, const MytValue& rhs) noexcept
+    -> MytValue {
+  if (lhs.is_numeric() && rhs.is_numeric()) {
+    return numeric_operation(
+        lhs, rhs, [](const auto& a, const auto& b) { return a / b; });
+  }
+  if (ElementWise::is_array(lhs) || ElementWise::is_array(rhs)) {
+    return ElementWise::apply(BinaryOp::Div, lhs, rhs);
+  }
+  return MytValue::from_object(lhs.to_object()->div(rhs.to_object()));
+}
+
+auto MytValue::compare(const BinaryOp& op,
+                       const MytValue& lhs,
+                       const MytValue& rhs) noexcept -> MytValue {
+  if (ElementWise::is_array(lhs) || ElementWise::is_array(rhs)) {
+    return ElementWise::apply(op, lhs, rhs);
+  }
+  if (lhs.is_error()) {
+    return lhs;
+  }
+  if (rhs.is_error()) {
+    return rhs;
+  }
+
+  if (lhs.is_numeric() && rhs.is_numeric()) {
+    return MytValue::from_bool(
+        compare_ordered(op, lhs.get_number(), rhs.get_number()));
+  }
+  if (lhs.tag() == Tag::Bool && rhs.tag() == Tag::Bool) {
+    const auto lhs_bool = static_cast<int>(lhs.get_bool());
+    const auto rhs_bool = static_cast<int>(rhs.get_bool());
+    return MytValue::from_bool(compare_ordered(op, lhs_bool, rhs_bool));
+  }
+  if (lhs.is_nil() && rhs.is_nil()) {
+    return MytValue::from_bool(compare_ordered(op, 0, 0));
+  }
+  const auto lhs_str = D_CAST(ValueObject<std::string>, lhs.get_object());
+  const auto rhs_str = D_CAST(ValueObject<std::string>, rhs.get_object());
+  if (lhs_str != nullptr && rhs_str != nullptr) {
+    return MytValue::from_bool(
+        compare_ordered(op, lhs_str->get_value(), rhs_str->get_value()));
+  }
+
+  if (op == BinaryOp::Eq || op == BinaryOp::NotEq) {
+    return MytValue::from_bool(op == BinaryOp::NotEq);
+  }
+  return MytValue::error("Invalid types for `" + op_literal(op) + "`");
+}
+
+auto MytValue::binary(const BinaryOp& op,
+                      const MytValue& lhs,
+                      const MytValue& rhs) noexcept -> MytValue {
+  switch (op) {
+    case BinaryOp::Add:
+      return MytValue::add(lhs, rhs);
+    case BinaryOp::Sub:
+      return MytValue::sub(lhs, rhs);
+    case BinaryOp::Mul:
+      return MytValue::mul(lhs, rhs);
+    case BinaryOp::Div:
+      return MytValue::div(lhs, rhs);
+    default:
+      return MytValue::compare(op, lhs, rhs);
+  }
+}
@@ -10,6 +10,8 @@
 #include <variant>
 
 #include "backend/myt_lang/ast.hpp"
+#include "backend/myt_lang/cell_pos.hpp"
+#include "backend/myt_lang/myt_builtins.hpp"
 #include "backend/myt_lang/token.hpp"
 
 auto Parser::print_result(const ParsingResult& result) noexcept -> void {
@@ -23,6 +25,15 @@ auto Parser::print_result(const ParsingResult& result) noexcept -> void {
 }
 
 auto Parser::parse(const Tokens& tokens) noexcept -> ParsingResult {
+  TokenViews views{};
+  views.reserve(tokens.size());
+  for (const auto& token : tokens) {
+    views.push_back(TokenView{token.type, token.literal});
+  }
+  return parse(views);
+}
+
+auto Parser::parse(const TokenViews& tokens) noexcept -> ParsingResult {
   using StringLiteral = ExpressionLiteral<std::string>;
 
   if (tokens.size() == 0) {
@@ -32,34 +43,59 @@ auto Parser::parse(const Tokens& tokens) noexcept -> ParsingResult {
     const auto concat_content = Parser::concat_token_literals(0, tokens);
     return std::make_shared<StringLiteral>(concat_content);
   }
+  auto tree = std::make_shared<ArenaTree>();
   std::size_t current_idx{1};
-  auto expr_result =
-      Parser::parse_expression(current_idx, tokens, Precendence::Lowest);
+  auto expr_result = Parser::parse_expression(current_idx, tokens,
+                                              Precendence::Lowest, tree->arena);
+  if (std::holds_alternative<ParsingError>(expr_result)) {
+    return std::get<ParsingError>(expr_result);
+  }
   if (tokens.at(current_idx).type != TokenType::EndOfCell) {
     const auto rest_concat = Parser::concat_token_literals(current_idx, tokens);
     return ParsingError{"Couldn't parse: `" + rest_concat + "`"};
   }
-  return std::shared_ptr(std::move(std::get<ExpressionPtr>(expr_result)));
+  tree->root = std::move(std::get<ExpressionPtr>(expr_result));
+  const auto root = tree->root.get();
+  return ExpressionSharedPtr{std::move(tree), root};
+}
+
+auto Parser::is_infix(const TokenType& type) noexcept -> bool {
+  switch (type) {
+    case TokenType::Plus:
+    case TokenType::Minus:
+    case TokenType::Asterisk:
+    case TokenType::Slash:
+    case TokenType::Colon:
+    case TokenType::Eq:
+    case TokenType::NotEq:
+    case TokenType::Gt:
+    case TokenType::Ge:
+    case TokenType::Lt:
+    case TokenType::Le:
+    case TokenType::LParen:
+      return true;
+    default:
+      return false;
+  }
 }
 
 auto Parser::parse_expression(std::size_t& token_idx,
-                              const Tokens& tokens,
-                              const Precendence&& precendence) noexcept
-    -> ParsingUniqueResult {
-  auto lhs_result = Parser::parse_prefix_fn(token_idx, tokens);
+                              const TokenViews& tokens,
+                              const Precendence&& precendence,
+                              Arena& arena) noexcept -> ParsingUniqueResult {
+  auto lhs_result = Parser::parse_prefix_fn(token_idx, tokens, arena);
   if (std::holds_alternative<ParsingError>(lhs_result)) {
     return lhs_result;
   }
 
   while (tokens.at(token_idx).type != TokenType::EndOfCell &&
          Parser::is_precendence_higher(token_idx, tokens, precendence)) {
-    if (!is_in_fns(infix_fns, tokens.at(token_idx).type)) {
+    if (!is_infix(tokens.at(token_idx).type)) {
       return lhs_result;
     }
-    const auto next_token_type = tokens.at(token_idx).type;
-    const auto infix_fn = infix_fns.at(next_token_type);
     const auto lhs_expression = &std::get<ExpressionPtr>(lhs_result);
-    lhs_result = infix_fn(std::move(*lhs_expression), token_idx, tokens);
+    lhs_result = Parser::parse_infix_fn(std::move(*lhs_expression), token_idx,
+                                        tokens, arena);
     if (std::holds_alternative<ParsingError>(lhs_result)) {
       return lhs_result;
     }
@@ -68,37 +104,71 @@ auto Parser::parse_expression(std::size_t& token_idx,
 }
 
 auto Parser::parse_prefix_fn(std::size_t& token_idx,
-                             const Tokens& tokens) noexcept
-    -> ParsingUniqueResult {
-  const auto current_token = tokens.at(token_idx);
-  if (Parser::is_in_fns(prefix_fns, current_token.type)) {
-    const auto prefixFn = prefix_fns.at(current_token.type);
-    return prefixFn(token_idx, tokens);
+                             const TokenViews& tokens,
+                             Arena& arena) noexcept -> ParsingUniqueResult {
+  const auto& current_token = tokens.at(token_idx);
+  switch (current_token.type) {
+    case TokenType::Minus:
+    case TokenType::Bang:
+      return parse_prefix_expression(token_idx, tokens, arena);
+    case TokenType::Identifier:
+      return parse_identifier(token_idx, tokens, arena);
+    case TokenType::CellIdentifier:
+      return parse_cell_identifier(token_idx, tokens, arena);
+    case TokenType::Int:
+      return parse_int_literal(token_idx, tokens, arena);
+    case TokenType::Float:
+      return parse_float_literal(token_idx, tokens, arena);
+    case TokenType::Bool:
+      return parse_bool_literal(token_idx, tokens, arena);
+    case TokenType::String:
+      return parse_string_literal(token_idx, tokens, arena);
+    case TokenType::LParen:
+      return parse_grouped_expression(token_idx, tokens, arena);
+    default:
+      return ParsingError{"Prefix expression for: `" +
+                          std::string(current_token.literal) +
+                          "` not implemented"};
+  }
+}
+
+auto Parser::parse_infix_fn(ExpressionPtr lhs_expression,
+                            std::size_t& token_idx,
+                            const TokenViews& tokens,
+                            Arena& arena) noexcept -> ParsingUniqueResult {
+  switch (tokens.at(token_idx).type) {
+    case TokenType::Colon:
+      return parse_infix_expression<ExpressionCellRange>(
+          std::move(lhs_expression), token_idx, tokens, arena);
+    case TokenType::LParen:
+      return parse_fn_call_expression(std::move(lhs_expression), token_idx,
+                                      tokens, arena);
+    default:
+      return parse_infix_expression<ExpressionInfix>(
+          std::move(lhs_expression), token_idx, tokens, arena);
   }
-  return ParsingError{"Prefix expression for: `" + current_token.literal +
-                      "` not implemented"};
 }
 
 auto Parser::concat_token_literals(const std::size_t& start_idx,
-                                   const Tokens& tokens) noexcept
+                                   const TokenViews& tokens) noexcept
     -> const std::string {
   if (tokens.empty() || (start_idx >= tokens.size()) ||
       (tokens.size() == 1 && tokens[0].type == TokenType::EndOfCell)) {
     return "";
   }
-  const auto concat_space_fold = [](const std::string& lhs, const Token& tok) {
+  const auto concat_space_fold = [](std::string lhs, const TokenView& tok) {
     if (tok.type == TokenType::EndOfCell)
       return lhs;
-    return lhs + " " + tok.literal;
+    return lhs.append(" ").append(tok.literal);
   };
   const auto begin = tokens.cbegin() + static_cast<long>(start_idx + 1);
   const auto end = tokens.cend();
-  const auto first_token = tokens.at(start_idx).literal;
+  const auto first_token = std::string(tokens.at(start_idx).literal);
   return std::accumulate(begin, end, first_token, concat_space_fold);
 }
 
 auto Parser::is_precendence_higher(const std::size_t& token_idx,
-                                   const Tokens& tokens,
+                                   const TokenViews& tokens,
                                    const Precendence& precendence) noexcept
     -> bool {
   const auto next_token_type = tokens.at(token_idx).type;
@@ -107,8 +177,8 @@ auto Parser::is_precendence_higher(const std::size_t& token_idx,
 }
 
 auto Parser::parse_call_arguments(std::size_t& token_idx,
-                                  const Tokens& tokens) noexcept
-    -> ArgumentsResult {
+                                  const TokenViews& tokens,
+                                  Arena& arena) noexcept -> ArgumentsResult {
   Arguments args{};
   if (tokens.at(token_idx).type == TokenType::RParen) {
     token_idx++;
@@ -116,7 +186,7 @@ auto Parser::parse_call_arguments(std::size_t& token_idx,
   }
 
   auto arg_result =
-      Parser::parse_expression(token_idx, tokens, Precendence::Lowest);
+      Parser::parse_expression(token_idx, tokens, Precendence::Lowest, arena);
   if (std::holds_alternative<ParsingError>(arg_result)) {
     return std::get<ParsingError>(arg_result);
   }
@@ -126,8 +196,8 @@ auto Parser::parse_call_arguments(std::size_t& token_idx,
   while (token_idx < tokens.size() &&
          tokens.at(token_idx).type == TokenType::Comma) {
     token_idx++;
-    auto arg_result =
-        Parser::parse_expression(token_idx, tokens, Precendence::Lowest);
+    auto arg_result = Parser::parse_expression(token_idx, tokens,
+                                               Precendence::Lowest, arena);
     if (std::holds_alternative<ParsingError>(arg_result)) {
       return std::get<ParsingError>(arg_result);
     }
@@ -138,7 +208,7 @@ auto Parser::parse_call_arguments(std::size_t& token_idx,
   if (token_idx < tokens.size() &&
       tokens.at(token_idx).type != TokenType::RParen) {
     return ParsingError{"Parsing arguments error, Expected: `)`, Got: " +
-                        tokens.at(token_idx).literal + "`"};
+                        std::string(tokens.at(token_idx).literal) + "`"};
   }
   token_idx++;
   return args;
@@ -146,79 +216,90 @@ auto Parser::parse_call_arguments(std::size_t& token_idx,
 
 // PREFIX
 auto Parser::parse_prefix_expression(std::size_t& token_idx,
-                                     const Tokens& tokens) noexcept
+                                     const TokenViews& tokens,
+                                     Arena& arena) noexcept
     -> ParsingUniqueResult {
-  const auto prefix_token = tokens.at(token_idx++);
+  const auto& prefix_token = tokens.at(token_idx++);
   auto rhs_result =
-      Parser::parse_expression(token_idx, tokens, Precendence::Prefix);
+      Parser::parse_expression(token_idx, tokens, Precendence::Prefix, arena);
   if (std::holds_alternative<ParsingError>(rhs_result)) {
     return rhs_result;
   }
   const auto rhs_expression = &std::get<ExpressionPtr>(rhs_result);
-  return std::make_unique<ExpressionPrefix>(prefix_token,
-                                            std::move(*rhs_expression));
+  return make_node<ExpressionPrefix>(arena, prefix_token.to_token(),
+                                     std::move(*rhs_expression));
 }
 
 auto Parser::parse_identifier(std::size_t& token_idx,
-                              const Tokens& tokens) noexcept -> ExpressionPtr {
-  const auto token = tokens.at(token_idx++);
-  return std::make_unique<ExpressionIdentifier>(token);
+                              const TokenViews& tokens,
+                              Arena& arena) noexcept -> ExpressionPtr {
+  const auto& token = tokens.at(token_idx++);
+  return make_node<ExpressionIdentifier>(arena, token.to_token());
 }
 
 auto Parser::parse_cell_identifier(std::size_t& token_idx,
-                                   const Tokens& tokens) noexcept
-    -> ExpressionPtr {
-  const auto cell_token = tokens.at(token_idx++);
-  return std::make_unique<ExpressionCell>(cell_token);
+                                   const TokenViews& tokens,
+                                   Arena& arena) noexcept
+    -> ParsingUniqueResult {
+  const auto& cell_token = tokens.at(token_idx++);
+  try {
+    const auto pos = CellPos{cell_token.literal};
+    return make_node<ExpressionCell>(arena, cell_token.to_token(), pos);
+  } catch (const InvalidCellString& err) {
+    return ParsingError{err.what()};
+  }
 }
 
 auto Parser::parse_int_literal(std::size_t& token_idx,
-                               const Tokens& tokens) noexcept
-    -> ParsingUniqueResult {
-  const auto int_token = tokens.at(token_idx++);
+                               const TokenViews& tokens,
+                               Arena& arena) noexcept -> ParsingUniqueResult {
+  const auto literal = std::string(tokens.at(token_idx++).literal);
   try {
-    const auto tokenValue = std::stoi(int_token.literal);
-    return std::make_unique<ExpressionLiteral<int>>(tokenValue);
+    const auto tokenValue = std::stoi(literal);
+    return make_node<ExpressionLiteral<int>>(arena, tokenValue);
   } catch (std::invalid_argument) {
-    return ParsingError{"Couldn't parse: `" + int_token.literal + "` to int"};
+    return ParsingError{"Couldn't parse: `" + literal + "` to int"};
   } catch (std::out_of_range) {
-    return ParsingError{"Couldn't parse: `" + int_token.literal +
+    return ParsingError{"Couldn't parse: `" + literal +
                         "` to int, target range: (" + std::to_string(INT_MIN) +
                         ", " + std::to_string(INT_MAX) + ")"};
   }
 }
 
 auto Parser::parse_float_literal(std::size_t& token_idx,
-                                 const Tokens& tokens) noexcept
-    -> ParsingUniqueResult {
-  const auto float_token = tokens.at(token_idx++);
-  const auto value = std::stod(float_token.literal);
+                                 const TokenViews& tokens,
+                                 Arena& arena) noexcept -> ParsingUniqueResult {
+  const auto& float_token = tokens.at(token_idx++);
+  const auto value = std::stod(std::string(float_token.literal));
   const auto value_correct_type = static_cast<FloatType>(value);
-  return std::make_unique<ExpressionLiteral<FloatType>>(value_correct_type);
+  return make_node<ExpressionLiteral<FloatType>>(arena, value_correct_type);
 }
 
 auto Parser::parse_bool_literal(std::size_t& token_idx,
-                                const Tokens& tokens) noexcept
-    -> ParsingUniqueResult {
+                                const TokenViews& tokens,
+                                Arena& arena) noexcept -> ParsingUniqueResult {
   const auto token_value = tokens.at(token_idx++).literal == "true";
-  return std::make_unique<ExpressionLiteral<bool>>(token_value);
+  return make_node<ExpressionLiteral<bool>>(arena, token_value);
 }
 
 auto Parser::parse_string_literal(std::size_t& token_idx,
-                                  const Tokens& tokens) noexcept
+                                  const TokenViews& tokens,
+                                  Arena& arena) noexcept
     -> ParsingUniqueResult {
-  const auto token_value = tokens.at(token_idx++).literal;
-  return std::make_unique<ExpressionLiteral<std::string>>(token_value);
+  const auto& token_value = tokens.at(token_idx++).literal;
+  return make_node<ExpressionLiteral<std::string>>(arena,
+                                                   std::string(token_value));
 }
 
 auto Parser::parse_grouped_expression(std::size_t& token_idx,
-                                      const Tokens& tokens) noexcept
+                                      const TokenViews& tokens,
+                                      Arena& arena) noexcept
     -> ParsingUniqueResult {
-  auto expr =
-      Parser::parse_expression(++token_idx, tokens, Precendence::Lowest);
+  auto expr = Parser::parse_expression(++token_idx, tokens,
+                                       Precendence::Lowest, arena);
   if (tokens.at(token_idx).type != TokenType::RParen) {
-    return ParsingError{"expected: `)`, got: `" + tokens.at(token_idx).literal +
-                        "`"};
+    return ParsingError{"expected: `)`, got: `" +
+                        std::string(tokens.at(token_idx).literal) + "`"};
   }
   token_idx++;
   return expr;
@@ -228,29 +309,48 @@ auto Parser::parse_grouped_expression(std::size_t& token_idx,
 template <class InfixType>
 auto Parser::parse_infix_expression(ExpressionPtr lhs_expression,
                                     std::size_t& token_idx,
-                                    const Tokens& tokens) noexcept
+                                    const TokenViews& tokens,
+                                    Arena& arena) noexcept
     -> ParsingUniqueResult {
-  const auto operator_token = tokens.at(token_idx++);
+  const auto& operator_token = tokens.at(token_idx++);
   const auto precendence = AstUtils::token_to_precendece(operator_token.type);
-  auto rhs_result =
-      Parser::parse_expression(token_idx, tokens, std::move(precendence));
+  auto rhs_result = Parser::parse_expression(token_idx, tokens,
+                                             std::move(precendence), arena);
   if (std::holds_alternative<ParsingError>(rhs_result)) {
     return rhs_result;
   }
   const auto rhs_expression = &std::get<ExpressionPtr>(rhs_result);
-  return std::make_unique<InfixType>(std::move(lhs_expression), operator_token,
-                                     std::move(*rhs_expression));
+  return make_node<InfixType>(arena, std::move(lhs_expression),
+                              operator_token.to_token(),
+                              std::move(*rhs_expression));
 }
 
 auto Parser::parse_fn_call_expression(ExpressionPtr lhs_expression,
                                       std::size_t& token_idx,
-                                      const Tokens& tokens) noexcept
+                                      const TokenViews& tokens,
+                                      Arena& arena) noexcept
     -> ParsingUniqueResult {
-  auto args_result = Parser::parse_call_arguments(++token_idx, tokens);
+  auto args_result = Parser::parse_call_arguments(++token_idx, tokens, arena);
   if (std::holds_alternative<ParsingError>(args_result)) {
     return std::get<ParsingError>(args_result);
   }
   auto& args = std::get<Arguments>(args_result);
-  return std::make_unique<ExpressionFnCall>(std::move(lhs_expression),
-                                            std::move(args));
+  if (lhs_expression->kind() != ExpressionKind::Identifier) {
+    return make_node<ExpressionFnCall>(arena, std::move(lhs_expression),
+                                       std::move(args));
+  }
+
+  const auto& name =
+      static_cast<const ExpressionIdentifier&>(*lhs_expression)
+          .get_name_token()
+          .literal;
+  const auto builtin = MytBuiltins::find(name);
+  if (!builtin) {
+    return ParsingError{"No function named: `" + name + "`"};
+  }
+  if (auto arity_err = MytBuiltins::check_arity(*builtin, args.size())) {
+    return ParsingError{*arity_err};
+  }
+  return make_node<ExpressionFnCall>(arena, std::move(lhs_expression),
+                                     std::move(args), builtin);
 }
@@ -0,0 +1,186 @@
+#include "../../../include/backend/myt_lang/vm.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "backend/myt_lang/evaluator.hpp"
+#include "backend/myt_lang/myt_builtins.hpp"
+
+auto Vm::execute(const Program& program,
+                 const Page& page,
+                 const CellOffset& offset) noexcept -> MytValue {
+  Stack stack{};
+  stack.reserve(program.max_stack);
+
+  std::size_t pc{0};
+  while (pc < program.code.size()) {
+    const auto& instruction = program.code[pc++];
+    switch (instruction.op) {
+      case OpCode::PushConst:
+        stack.push_back(program.constants[instruction.operand]);
+        break;
+      case OpCode::LoadCell:
+        stack.push_back(
+            load_cell(offset.apply(program.cells[instruction.operand]), page));
+        break;
+      case OpCode::LoadRange: {
+        const auto& range = program.ranges[instruction.operand];
+        if (offset.is_zero()) {
+          stack.push_back(Evaluator::get_cell_range_obj(
+              range.begin, range.end, range.range_str, page));
+          break;
+        }
+        // Range literals are canonical A1, so the shifted text is rebuilt
+        const auto begin = offset.apply(range.begin);
+        const auto end = offset.apply(range.end);
+        stack.push_back(Evaluator::get_cell_range_obj(
+            begin, end, begin.to_string() + ":" + end.to_string(), page));
+        break;
+      }
+      case OpCode::Neg:
+        stack.back() = neg(stack.back());
+        break;
+      case OpCode::Not:
+        stack.back() = logical_not(stack.back());
+        break;
+      case OpCode::Add:
+      case OpCode::Sub:
+      case OpCode::Mul:
+      case OpCode::Div:
+      case OpCode::Eq:
+      case OpCode::NotEq:
+      case OpCode::Gt:
+      case OpCode::Ge:
+      case OpCode::Lt:
+      case OpCode::Le: {
+        const auto rhs = std::move(stack.back());
+        stack.pop_back();
+        stack.back() = binary(instruction.op, stack.back(), rhs);
+        break;
+      }
+      case OpCode::CallBuiltin: {
+        const auto builtin = static_cast<BuiltinId>(instruction.operand);
+        auto result = call_builtin(builtin, stack, instruction.argc);
+        stack.push_back(std::move(result));
+        break;
+      }
+      case OpCode::ToBool: {
+        const auto builtin = static_cast<BuiltinId>(instruction.operand);
+        stack.back() = MytBuiltins::to_condition(builtin, stack.back());
+        break;
+      }
+      case OpCode::Jump:
+        pc = instruction.operand;
+        break;
+      case OpCode::JumpIfFalse:
+      case OpCode::JumpIfTrue: {
+        const auto jump_on = instruction.op == OpCode::JumpIfTrue;
+        const auto cond = stack.back().get_bool();
+        stack.pop_back();
+        if (cond == jump_on) {
+          pc = instruction.operand;
+        }
+        break;
+      }
+      case OpCode::JumpIfError:
+        if (stack.back().is_error()) {
+          pc = instruction.operand;
+        }
+        break;
+      case OpCode::JumpUnlessError:
+        if (!stack.back().is_error()) {
+          pc = instruction.operand;
+        }
+        break;
+      case OpCode::Pop:
+        stack.pop_back();
+        break;
+      case OpCode::Switch: {
+        const auto& targets = program.jump_tables[instruction.operand];
+        auto choice = MytBuiltins::to_choice(stack.back(), instruction.argc);
+        stack.pop_back();
+        if (choice.is_error()) {
+          stack.push_back(std::move(choice));
+          pc = targets.back();
+        } else {
+          pc = targets[static_cast<std::size_t>(choice.get_int()) - 1];
+        }
+        break;
+      }
+    }
+  }
+
+  if (stack.empty()) {
+    return MytValue{};
+  }
+  return CellRangeObject::detach(std::move(stack.back()));
+}
+
+auto Vm::load_cell(const CellPos& pos, const Page& page) noexcept
+    -> MytValue {
+  const auto data_cell = page.get_cell(pos);
+  if (data_cell == nullptr) {
+    return MytValue{};
+  }
+  return data_cell->get_value();
+}
+
+auto Vm::neg(const MytValue& value) noexcept -> MytValue {
+  switch (value.tag()) {
+    case MytValue::Tag::Int:
+      return MytValue::from_int(-value.get_int());
+    case MytValue::Tag::Float:
+      return MytValue::from_float(-value.get_float());
+    default:
+      return MytValue::error("Invalid prefix `-` argument");
+  }
+}
+
+auto Vm::logical_not(const MytValue& value) noexcept -> MytValue {
+  if (value.tag() != MytValue::Tag::Bool) {
+    return MytValue::error("Invalid prefix `!` argument");
+  }
+  return MytValue::from_bool(!value.get_bool());
+}
+
+auto Vm::binary(const OpCode& op,
+                const MytValue& lhs,
+                const MytValue& rhs) noexcept -> MytValue {
+  switch (op) {
+    case OpCode::Add:
+      return MytValue::add(lhs, rhs);
+    case OpCode::Sub:
+      return MytValue::sub(lhs, rhs);
+    case OpCode::Mul:
+      return MytValue::mul(lhs, rhs);
+    case OpCode::Div:
+      if (rhs.is_numeric() && rhs.get_number() == 0) {
+        return MytValue::from_object(ZERO_DIV_ERR);
+      }
+      return MytValue::div(lhs, rhs);
+    case OpCode::Eq:
+      return MytValue::compare(BinaryOp::Eq, lhs, rhs);
+    case OpCode::NotEq:
+      return MytValue::compare(BinaryOp::NotEq, lhs, rhs);
+    case OpCode::Gt:
+      return MytValue::compare(BinaryOp::Gt, lhs, rhs);
+    case OpCode::Ge:
+      return MytValue::compare(BinaryOp::Ge, lhs, rhs);
+    case OpCode::Lt:
+      return MytValue::compare(BinaryOp::Lt, lhs, rhs);
+    default:
+      return MytValue::compare(BinaryOp::Le, lhs, rhs);
+  }
+}
+
+auto Vm::call_builtin(const BuiltinId& builtin,
+                      Stack& stack,
+                      const uint16_t& argc) noexcept -> MytValue {
+  const auto first_arg = stack.end() - static_cast<std::ptrdiff_t>(argc);
+  MytValueArgs args(std::make_move_iterator(first_arg),
+                    std::make_move_iterator(stack.end()));
+  stack.erase(first_arg, stack.end());
+  return MytBuiltins::call(builtin, args);
+}
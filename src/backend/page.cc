@@ -1,22 +1,143 @@
 #include "../../include/backend/page.hpp"
 
+#include <atomic>
+#include <utility>
+
 std::optional<std::string> Page::get_cell_raw_content(
     const CellPos& pos) const noexcept {
-  if (!cell_exists(pos)) return std::nullopt;
-  return m_cells.at(pos).get_raw_content();
+  const auto data_cell = get_cell(pos);
+  if (data_cell == nullptr) return std::nullopt;
+  return data_cell->get_raw_content();
 }
 
 auto Page::get_cell_eval_content(const CellPos& pos) const noexcept
     -> std::optional<std::string> {
-  if (!cell_exists(pos)) return std::nullopt;
-  return m_cells.at(pos).to_string();
+  const auto data_cell = get_cell(pos);
+  if (data_cell == nullptr) return std::nullopt;
+  return data_cell->to_string();
+}
+
+auto Page::get_cell(const CellPos& pos) const noexcept -> const DataCell* {
+  const auto block = get_block(pos.col, CellBlock::block_idx(pos.row));
+  if (block == nullptr) return nullptr;
+  return block->get(CellBlock::row_offset(pos.row));
+}
+
+auto Page::get_block(const CellLimitType& col,
+                     const std::size_t& block_idx) const noexcept
+    -> const CellBlock* {
+  const auto column_it = m_columns.find(col);
+  if (column_it == m_columns.cend()) return nullptr;
+  return get_block(&column_it->second, block_idx);
+}
+
+auto Page::get_block(const Column* column,
+                     const std::size_t& block_idx) noexcept
+    -> const CellBlock* {
+  if (column == nullptr || block_idx >= column->size()) return nullptr;
+  return (*column)[block_idx].get();
 }
 
 bool Page::cell_exists(const CellPos& pos) const noexcept {
-  return m_cells.find(pos) != m_cells.end();
+  return get_cell(pos) != nullptr;
+}
+
+auto Page::save_cell(const DataCell& data_cell, const CellPos& pos) noexcept
+    -> void {
+  auto& block = mutable_block(pos);
+  const auto offset = CellBlock::row_offset(pos.row);
+  if (block.get(offset) == nullptr) {
+    m_size++;
+  }
+  const auto old_number = block.number(offset);
+  block.set(offset, data_cell);
+  update_index(pos, old_number);
 }
 
 void Page::erase_cell(const CellPos& pos) noexcept {
   if (!cell_exists(pos)) return;
-  m_cells.erase(pos);
+  auto& column = m_columns.at(pos.col);
+  const auto block_idx = CellBlock::block_idx(pos.row);
+  auto& block = mutable_block(pos);
+  const auto offset = CellBlock::row_offset(pos.row);
+  const auto old_number = block.number(offset);
+  block.erase(offset);
+  m_size--;
+
+  if (!block.empty()) {
+    update_index(pos, old_number);
+    return;
+  }
+  column[block_idx].reset();
+  update_index(pos, old_number);
+  while (!column.empty() && column.back() == nullptr) {
+    column.pop_back();
+  }
+  if (column.empty()) {
+    m_columns.erase(pos.col);
+  }
+}
+
+auto Page::mutable_block(const CellPos& pos) noexcept -> CellBlock& {
+  auto& column = m_columns[pos.col];
+  const auto block_idx = CellBlock::block_idx(pos.row);
+  if (block_idx >= column.size()) {
+    column.resize(block_idx + 1);
+  }
+  auto& block = column[block_idx];
+  if (block == nullptr) {
+    block = std::make_shared<CellBlock>();
+  } else if (block.use_count() > 1) {
+    block = std::make_shared<CellBlock>(*block);
+  } else {
+    // Another page on another thread may just have dropped its share of the
+    // block, make its reads happen before our writes
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return *block;
+}
+
+auto Page::set_aggregate_index(const CellLimitType& col,
+                               const bool& enabled) noexcept -> void {
+  if (!enabled) {
+    m_indexes.erase(col);
+    return;
+  }
+  if (m_indexes.find(col) != m_indexes.cend()) return;
+  auto index = std::make_shared<AggregateIndex>();
+  const auto column_it = m_columns.find(col);
+  if (column_it != m_columns.cend()) {
+    const auto& column = column_it->second;
+    for (std::size_t block_idx{0}; block_idx < column.size(); ++block_idx) {
+      if (column[block_idx] != nullptr) {
+        index->update(block_idx, column[block_idx].get());
+      }
+    }
+  }
+  m_indexes.emplace(col, std::move(index));
+}
+
+auto Page::get_aggregate_index(const CellLimitType& col) const noexcept
+    -> const AggregateIndex* {
+  const auto index_it = m_indexes.find(col);
+  return (index_it != m_indexes.cend()) ? index_it->second.get() : nullptr;
+}
+
+auto Page::update_index(const CellPos& pos,
+                        const std::optional<double>& old_number) noexcept
+    -> void {
+  const auto index_it = m_indexes.find(pos.col);
+  if (index_it == m_indexes.cend()) return;
+  auto& index = index_it->second;
+  if (index.use_count() > 1) {
+    index = std::make_shared<AggregateIndex>(*index);
+  } else {
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  const auto block_idx = CellBlock::block_idx(pos.row);
+  const auto block = get_block(pos.col, block_idx);
+  const auto new_number =
+      (block != nullptr) ? block->number(CellBlock::row_offset(pos.row))
+                         : std::nullopt;
+  index->update_cell(block_idx, block, old_number, new_number);
 }
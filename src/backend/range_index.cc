@@ -0,0 +1,171 @@
+#include "../../include/backend/range_index.hpp"
+
+#include <algorithm>
+
+// INTERVAL TREAP
+
+auto IntervalTreap::insert(const uint32_t& lo,
+                           const uint32_t& hi,
+                           const uint32_t& id) noexcept -> void {
+  const auto new_node = Node{lo, hi, hi, id, next_priority()};
+  NodeIdx new_idx{NIL};
+  if (!m_free.empty()) {
+    new_idx = m_free.back();
+    m_free.pop_back();
+    node(new_idx) = new_node;
+  } else {
+    new_idx = static_cast<NodeIdx>(m_nodes.size());
+    m_nodes.push_back(new_node);
+  }
+  m_root = insert(m_root, new_idx);
+}
+
+auto IntervalTreap::erase(const uint32_t& lo, const uint32_t& id) noexcept
+    -> void {
+  m_root = erase(m_root, lo, id);
+}
+
+auto IntervalTreap::update(const NodeIdx& idx) noexcept -> void {
+  auto& current = node(idx);
+  current.max_hi = current.hi;
+  if (current.left != NIL) {
+    current.max_hi = std::max(current.max_hi, node(current.left).max_hi);
+  }
+  if (current.right != NIL) {
+    current.max_hi = std::max(current.max_hi, node(current.right).max_hi);
+  }
+}
+
+auto IntervalTreap::rotate_left(const NodeIdx& idx) noexcept -> NodeIdx {
+  const auto pivot = node(idx).right;
+  node(idx).right = node(pivot).left;
+  node(pivot).left = idx;
+  update(idx);
+  update(pivot);
+  return pivot;
+}
+
+auto IntervalTreap::rotate_right(const NodeIdx& idx) noexcept -> NodeIdx {
+  const auto pivot = node(idx).left;
+  node(idx).left = node(pivot).right;
+  node(pivot).right = idx;
+  update(idx);
+  update(pivot);
+  return pivot;
+}
+
+auto IntervalTreap::insert(const NodeIdx& root, const NodeIdx& new_idx) noexcept
+    -> NodeIdx {
+  if (root == NIL) {
+    return new_idx;
+  }
+  const auto& inserted = node(new_idx);
+  auto new_root = root;
+  if (is_before(inserted.lo, inserted.id, node(root))) {
+    node(root).left = insert(node(root).left, new_idx);
+    if (node(node(root).left).priority > node(root).priority) {
+      new_root = rotate_right(root);
+    }
+  } else {
+    node(root).right = insert(node(root).right, new_idx);
+    if (node(node(root).right).priority > node(root).priority) {
+      new_root = rotate_left(root);
+    }
+  }
+  update(root);
+  update(new_root);
+  return new_root;
+}
+
+auto IntervalTreap::erase(const NodeIdx& root,
+                          const uint32_t& lo,
+                          const uint32_t& id) noexcept -> NodeIdx {
+  if (root == NIL) {
+    return NIL;
+  }
+  auto& current = node(root);
+  if (current.lo == lo && current.id == id) {
+    const auto merged = merge(current.left, current.right);
+    m_free.push_back(root);
+    return merged;
+  }
+  if (is_before(lo, id, current)) {
+    node(root).left = erase(current.left, lo, id);
+  } else {
+    node(root).right = erase(current.right, lo, id);
+  }
+  update(root);
+  return root;
+}
+
+auto IntervalTreap::merge(const NodeIdx& lhs, const NodeIdx& rhs) noexcept
+    -> NodeIdx {
+  if (lhs == NIL) return rhs;
+  if (rhs == NIL) return lhs;
+  if (node(lhs).priority > node(rhs).priority) {
+    node(lhs).right = merge(node(lhs).right, rhs);
+    update(lhs);
+    return lhs;
+  }
+  node(rhs).left = merge(lhs, node(rhs).left);
+  update(rhs);
+  return rhs;
+}
+
+auto IntervalTreap::next_priority() noexcept -> uint32_t {
+  // splitmix64, deterministic so indexes behave the same on every run
+  m_seed += 0x9E3779B97F4A7C15;
+  auto z = m_seed;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return static_cast<uint32_t>(z ^ (z >> 31));
+}
+
+// RANGE INDEX
+
+auto RangeIndex::insert(const CellPos& owner,
+                        const CellPos& begin,
+                        const CellPos& end) noexcept -> void {
+  uint32_t entry_idx{0};
+  if (!m_free_entries.empty()) {
+    entry_idx = m_free_entries.back();
+    m_free_entries.pop_back();
+    m_entries[entry_idx] = Entry{owner, begin, end};
+  } else {
+    entry_idx = static_cast<uint32_t>(m_entries.size());
+    m_entries.push_back(Entry{owner, begin, end});
+  }
+  m_owner_entries[owner].push_back(entry_idx);
+
+  for (auto band = begin.col / BAND_COLS; band <= end.col / BAND_COLS;
+       ++band) {
+    m_bands[band].insert(begin.row, end.row, entry_idx);
+  }
+}
+
+auto RangeIndex::erase_owner(const CellPos& owner) noexcept -> void {
+  const auto owner_it = m_owner_entries.find(owner);
+  if (owner_it == m_owner_entries.end()) {
+    return;
+  }
+  for (const auto& entry_idx : owner_it->second) {
+    const auto& entry = m_entries[entry_idx];
+    for (auto band = entry.begin.col / BAND_COLS;
+         band <= entry.end.col / BAND_COLS; ++band) {
+      auto& treap = m_bands.at(band);
+      treap.erase(entry.begin.row, entry_idx);
+      if (treap.empty()) {
+        m_bands.erase(band);
+      }
+    }
+    m_free_entries.push_back(entry_idx);
+  }
+  m_owner_entries.erase(owner_it);
+}
+
+auto RangeIndex::clear() noexcept -> void {
+  m_entries.clear();
+  m_free_entries.clear();
+  m_owner_entries.clear();
+  m_bands.clear();
+}
@@ -3,26 +3,43 @@
 #include <qobject.h>
 #include <qtmetamacros.h>
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <string>
+#include <utility>
 
 #include "backend/data_cell.hpp"
 #include "backend/myt_lang/cell_pos.hpp"
 #include "backend/myt_lang/evaluator.hpp"
-#include "backend/myt_lang/lexer.hpp"
+#include "backend/myt_lang/formula.hpp"
 #include "backend/myt_lang/myt_object.hpp"
 #include "backend/myt_lang/parser.hpp"
 #include "global_utils/global_utils.hpp"
 
 State::State(QObject* parent)
-    : QObject(parent), m_pages({Page{}}), m_dependencies_handler() {}
+    : QObject(parent),
+      m_pages({Page{}}),
+      m_dependencies_handler(),
+      m_thread_pool(),
+      m_recalc_thread(),
+      m_pending_seeds(),
+      m_recalc_results_mutex(),
+      m_recalc_results(),
+      m_viewport_mutex(),
+      m_viewport() {}
+
+State::~State() {
+  stop_recalc();
+}
 
 auto State::get_content_by_pos(const CellLimitType& col,
                                const CellLimitType& row) noexcept -> QString {
   const CellPos pos{col, row};
-  const auto current_page = m_pages.at(m_current_page_idx);
+  const auto& current_page = m_pages.at(m_current_page_idx);
   const auto cell = current_page.get_cell_eval_content(pos);
   return QString::fromStdString(cell.value_or(""));
 }
@@ -46,15 +63,74 @@ auto State::eval_save(const QString& raw_content,
 
 auto State::log_cells() const noexcept -> void {
   const auto& current_page = m_pages.at(m_current_page_idx);
-  for (const auto& [pos, dc] : current_page.get_cells()) {
+  current_page.for_each_cell([](const CellPos& pos, const DataCell& dc) {
     std::cout << pos.col << ":" << pos.row << ": `" << dc.to_string() << "`\n";
+  });
+}
+
+auto State::set_viewport(const CellLimitType& col,
+                         const CellLimitType& row,
+                         const CellLimitType& cols,
+                         const CellLimitType& rows) noexcept -> void {
+  std::optional<Viewport> viewport{};
+  if (cols > 0 && rows > 0) {
+    // The last value is never a cell, loops over the viewport stop before it
+    const auto last = [](const CellLimitType& first,
+                         const CellLimitType& count) {
+      return static_cast<CellLimitType>(std::min(
+          std::size_t{first} + count - 1,
+          std::size_t{std::numeric_limits<CellLimitType>::max()} - 1));
+    };
+    const auto begin = CellPos{std::max<CellLimitType>(col, 1),
+                               std::max<CellLimitType>(row, 1)};
+    const auto end = CellPos{last(col, cols), last(row, rows)};
+    if (begin.col <= end.col && begin.row <= end.row) {
+      viewport.emplace(begin, end);
+    }
+  }
+  {
+    const std::lock_guard<std::mutex> lock{m_viewport_mutex};
+    m_viewport = viewport;
   }
+  m_viewport_version.fetch_add(1);
 }
 
 auto State::flush_dependencies() noexcept -> void {
   m_dependencies_handler.flush_dependencies();
 }
 
+auto State::set_recalc_workers(const std::size_t& n_workers) noexcept
+    -> void {
+  // The background recalculation evaluates on the current pool
+  wait_for_recalc();
+  if (n_workers <= 1) {
+    m_thread_pool.reset();
+    return;
+  }
+  if (m_thread_pool == nullptr || m_thread_pool->size() != n_workers) {
+    m_thread_pool = std::make_unique<ThreadPool>(n_workers);
+  }
+}
+
+auto State::set_async_recalc(const bool& enabled) noexcept -> void {
+  if (!enabled) {
+    wait_for_recalc();
+  }
+  m_async_recalc = enabled;
+}
+
+auto State::set_aggregate_index(const CellLimitType& col,
+                                const bool& enabled) noexcept -> void {
+  m_pages.at(m_current_page_idx).set_aggregate_index(col, enabled);
+}
+
+auto State::wait_for_recalc() noexcept -> void {
+  if (m_recalc_thread.joinable()) {
+    m_recalc_thread.join();
+  }
+  apply_recalc_results();
+}
+
 auto State::get_dependencies() const noexcept
     -> const DependenciesHandler::Dependencies {
   return m_dependencies_handler.get_dependencies();
@@ -81,26 +157,30 @@ void State::setEditingRow(int row) {
 
 auto State::evaluate(const std::string& content, const CellPos& pos) noexcept
     -> void {
-  const auto cells = m_pages.at(m_current_page_idx).get_cells();
-  const auto tokens = Lexer::tokenize(content);
-  const auto parsed = Parser::parse(tokens);
+  const auto formula = Formula::compile(content, pos);
+  const auto& parsed = formula->get_parsed();
 
-  m_dependencies_handler.update_dependencies(pos, parsed);
+  m_dependencies_handler.update_dependencies(pos, parsed,
+                                             formula->offset_to(pos));
 
-  const auto cyclic_pos = m_dependencies_handler.catch_circling_cells_DFS();
+  const auto cyclic_pos = m_dependencies_handler.find_cycle_through(pos);
   if (!cyclic_pos.empty()) {
     m_dependencies_handler.filter_cyclic_dependencies(cyclic_pos);
     set_cyclic_dependencies_errors(cyclic_pos);
-    for (const auto& c_pos : cyclic_pos) {
-      reeval_affected(c_pos);
-    }
+    recalc(cyclic_pos);
     return;
   }
 
-  const auto obj = Evaluator::evaluate(parsed, cells);
-  const auto data_cell = DataCell{content, obj};
+  const auto& current_page = m_pages.at(m_current_page_idx);
+  const auto obj = formula->evaluate(current_page, pos);
+  const auto data_cell = DataCell{content, obj, formula};
+  // Rewriting the same value leaves the dependents as they are, unless an
+  // unfinished recalculation could still overwrite the cell
+  const auto changed = value_changed(current_page, pos, data_cell.get_value());
   save_data_cell(pos, data_cell);
-  reeval_affected(pos);
+  if (changed || !m_pending_seeds.empty()) {
+    recalc({pos});
+  }
 }
 
 auto State::save_data_cell(const CellPos& pos,
@@ -115,15 +195,15 @@ auto State::set_cyclic_dependencies_errors(const Container& positions) noexcept
   const auto positions_str = build_cell_pos_str(positions);
   const auto err_msg = "CYCLE: " + positions_str;
   const auto err_obj = Evaluator::get_error_obj(err_msg);
-  const auto cells = m_pages.at(m_current_page_idx).get_cells();
+  const auto& current_page = m_pages.at(m_current_page_idx);
 
   for (const auto& pos : positions) {
-    if (cells.find(pos) == cells.cend()) {
+    const auto data_cell = current_page.get_cell(pos);
+    if (data_cell == nullptr) {
       continue;
     }
-    const auto data_cell = cells.at(pos);
-    const auto content = data_cell.get_raw_content();
-    const auto data_cell_err = DataCell{content, err_obj};
+    const auto data_cell_err = DataCell{data_cell->get_raw_content(), err_obj,
+                                        data_cell->get_formula()};
     save_data_cell(pos, data_cell_err);
   }
 }
@@ -142,16 +222,311 @@ auto State::build_cell_pos_str(const Container& c) -> std::string {
   return "(" + res + ")";
 }
 
-auto State::reeval_affected(const CellPos& pos) noexcept -> void {
-  using PosSet = std::unordered_set<CellPos>;
-  const auto affected_positions =
-      m_dependencies_handler.get_affected_positions(pos).value_or(PosSet{});
+auto State::recalc(const DependenciesHandler::CellPosSet& seeds) noexcept
+    -> void {
+  if (m_async_recalc) {
+    start_recalc(seeds);
+  } else {
+    reeval_affected(seeds);
+  }
+}
 
-  const auto cells = m_pages.at(m_current_page_idx).get_cells();
-  for (const auto& affected_pos : affected_positions) {
-    const auto data_cell = cells.at(affected_pos);
-    const auto content = data_cell.get_raw_content();
-    evaluate(content, affected_pos);
-    emit requestCellUpdate(affected_pos.col, affected_pos.row);
+auto State::reeval_affected(
+    const DependenciesHandler::CellPosSet& seeds) noexcept -> void {
+  const auto generation = m_recalc_generation.load();
+  const auto plan = m_dependencies_handler.get_recalc_plan(seeds);
+  auto& current_page = m_pages.at(m_current_page_idx);
+  DependenciesHandler::CellPosSet outdated{};
+  for (const auto& seed : seeds) {
+    mark_outdated(plan, seed, outdated);
   }
+  for (const auto& level : plan.levels) {
+    const auto cells = take_outdated(level, outdated);
+    if (cells.empty()) {
+      continue;
+    }
+    auto results =
+        evaluate_cells(current_page, cells, 0, cells.size(), generation);
+    QList<int> positions{};
+    for (std::size_t i{0}; i < cells.size(); ++i) {
+      if (!results[i].has_value() ||
+          !value_changed(current_page, cells[i], results[i]->get_value())) {
+        continue;
+      }
+      current_page.save_cell(*results[i], cells[i]);
+      mark_outdated(plan, cells[i], outdated);
+      positions.push_back(cells[i].col);
+      positions.push_back(cells[i].row);
+    }
+    if (!positions.empty()) {
+      emit requestCellsUpdate(positions);
+    }
+  }
+}
+
+auto State::start_recalc(const DependenciesHandler::CellPosSet& seeds) noexcept
+    -> void {
+  // Results of a superseded recalculation are dropped, its seeds stay
+  // pending so their dependents are recalculated by this one
+  stop_recalc();
+  m_pending_seeds.insert(seeds.cbegin(), seeds.cend());
+  auto plan = m_dependencies_handler.get_recalc_plan(m_pending_seeds);
+  if (plan.levels.empty()) {
+    m_pending_seeds.clear();
+    return;
+  }
+  const auto generation = m_recalc_generation.load();
+  m_recalc_thread = std::thread{
+      [this, generation, plan = std::move(plan), pending = m_pending_seeds,
+       page = m_pages.at(m_current_page_idx)]() mutable {
+        run_recalc(generation, plan, pending, page);
+      }};
+}
+
+auto State::stop_recalc() noexcept -> void {
+  m_recalc_generation.fetch_add(1);
+  if (m_recalc_thread.joinable()) {
+    m_recalc_thread.join();
+  }
+}
+
+auto State::run_recalc(const std::uint64_t& generation,
+                       const DependenciesHandler::RecalcPlan& plan,
+                       const DependenciesHandler::CellPosSet& seeds,
+                       Page& page) noexcept -> void {
+  auto run = RecalcRun{plan, {}, 0, {}, {}, {}};
+  for (const auto& seed : seeds) {
+    mark_outdated(plan, seed, run.outdated);
+  }
+  // Versions start at 0, the first slice always looks at the viewport
+  auto seen_viewport = std::numeric_limits<std::uint64_t>::max();
+  for (; run.level_idx < plan.levels.size(); ++run.level_idx) {
+    const auto& level = plan.levels[run.level_idx];
+    for (std::size_t begin{0}; begin < level.size();
+         begin += RECALC_BATCH_CELLS) {
+      const auto viewport_version = m_viewport_version.load();
+      if (viewport_version != seen_viewport) {
+        seen_viewport = viewport_version;
+        if (!recalc_visible(run, page, generation)) {
+          return;
+        }
+      }
+      const auto end = std::min(level.size(), begin + RECALC_BATCH_CELLS);
+      const auto slice = std::vector<CellPos>(
+          level.cbegin() + static_cast<std::ptrdiff_t>(begin),
+          level.cbegin() + static_cast<std::ptrdiff_t>(end));
+      if (!recalc_cells(run, slice, page, generation)) {
+        return;
+      }
+    }
+  }
+  post_recalc_results(RecalcBatch{generation, {}, true});
+}
+
+auto State::recalc_cells(RecalcRun& run,
+                         const std::vector<CellPos>& cells,
+                         Page& page,
+                         const std::uint64_t& generation) noexcept -> bool {
+  const auto outdated_cells = take_outdated(cells, run.outdated);
+  for (std::size_t begin{0}; begin < outdated_cells.size();
+       begin += RECALC_BATCH_CELLS) {
+    const auto end =
+        std::min(outdated_cells.size(), begin + RECALC_BATCH_CELLS);
+    auto results = evaluate_cells(page, outdated_cells, begin, end, generation);
+    if (is_stale(generation)) {
+      return false;
+    }
+    auto batch = RecalcBatch{generation, {}, false};
+    batch.cells.reserve(results.size());
+    for (std::size_t i{begin}; i < end; ++i) {
+      const auto& pos = outdated_cells[i];
+      auto& data_cell = results[i - begin];
+      if (!data_cell.has_value() ||
+          !value_changed(page, pos, data_cell->get_value())) {
+        continue;
+      }
+      page.save_cell(*data_cell, pos);
+      mark_outdated(run.plan, pos, run.outdated);
+      batch.cells.emplace_back(pos, std::move(*data_cell));
+    }
+    if (!batch.cells.empty()) {
+      post_recalc_results(std::move(batch));
+    }
+  }
+  return true;
+}
+
+auto State::recalc_visible(RecalcRun& run,
+                           Page& page,
+                           const std::uint64_t& generation) noexcept -> bool {
+  const auto viewport = get_viewport();
+  if (!viewport.has_value()) {
+    return true;
+  }
+  if (run.level_of.empty()) {
+    for (std::size_t idx{0}; idx < run.plan.levels.size(); ++idx) {
+      for (const auto& pos : run.plan.levels[idx]) {
+        run.level_of.emplace(pos, idx);
+      }
+    }
+    for (const auto& [pos, dependents] : run.plan.affected) {
+      for (const auto& dependent : dependents) {
+        run.precedents[dependent].push_back(pos);
+      }
+    }
+  }
+
+  // Visible cells still to recalculate and every recalculated cell they
+  // read, by level so each cell comes after its precedents
+  std::map<std::size_t, std::vector<CellPos>> levels{};
+  std::vector<CellPos> stack{};
+  const auto visit = [&](const CellPos& pos) {
+    const auto level_it = run.level_of.find(pos);
+    if (level_it == run.level_of.cend() || level_it->second < run.level_idx ||
+        !run.visible_done.insert(pos).second) {
+      return;
+    }
+    levels[level_it->second].push_back(pos);
+    stack.push_back(pos);
+  };
+  const auto& [begin, end] = *viewport;
+  const auto area = std::size_t{end.col - begin.col + 1u} *
+                    std::size_t{end.row - begin.row + 1u};
+  if (area <= run.level_of.size()) {
+    for (auto col = begin.col; col <= end.col; ++col) {
+      for (auto row = begin.row; row <= end.row; ++row) {
+        visit(CellPos{col, row});
+      }
+    }
+  } else {
+    for (const auto& [pos, level] : run.level_of) {
+      if (pos.col >= begin.col && pos.col <= end.col && pos.row >= begin.row &&
+          pos.row <= end.row) {
+        visit(pos);
+      }
+    }
+  }
+  while (!stack.empty()) {
+    const auto pos = stack.back();
+    stack.pop_back();
+    const auto precedents_it = run.precedents.find(pos);
+    if (precedents_it == run.precedents.cend()) continue;
+    for (const auto& precedent : precedents_it->second) {
+      visit(precedent);
+    }
+  }
+
+  for (const auto& [level, cells] : levels) {
+    if (!recalc_cells(run, cells, page, generation)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto State::get_viewport() const noexcept -> std::optional<Viewport> {
+  const std::lock_guard<std::mutex> lock{m_viewport_mutex};
+  return m_viewport;
+}
+
+auto State::post_recalc_results(RecalcBatch&& batch) noexcept -> void {
+  {
+    const std::lock_guard<std::mutex> lock{m_recalc_results_mutex};
+    m_recalc_results.push_back(std::move(batch));
+  }
+  QMetaObject::invokeMethod(
+      this, [this] { apply_recalc_results(); }, Qt::QueuedConnection);
+}
+
+auto State::apply_recalc_results() noexcept -> void {
+  std::vector<RecalcBatch> batches{};
+  {
+    const std::lock_guard<std::mutex> lock{m_recalc_results_mutex};
+    batches.swap(m_recalc_results);
+  }
+  const auto generation = m_recalc_generation.load();
+  // One update per batch, in the order they were posted, so visible cells
+  // recalculated first also reach the grid first
+  for (const auto& batch : batches) {
+    if (batch.generation != generation) {
+      continue;
+    }
+    QList<int> positions{};
+    for (const auto& [pos, data_cell] : batch.cells) {
+      save_data_cell(pos, data_cell);
+      // A superseding recalculation compares against this value, its
+      // dependents have to be reached as if it was edited
+      m_pending_seeds.insert(pos);
+      positions.push_back(pos.col);
+      positions.push_back(pos.row);
+    }
+    if (batch.is_last) {
+      m_pending_seeds.clear();
+    }
+    if (!positions.empty()) {
+      emit requestCellsUpdate(positions);
+    }
+  }
+}
+
+auto State::evaluate_cells(const Page& page,
+                           const std::vector<CellPos>& cells,
+                           const std::size_t& begin,
+                           const std::size_t& end,
+                           const std::uint64_t& generation) const noexcept
+    -> std::vector<std::optional<DataCell>> {
+  std::vector<std::optional<DataCell>> results(end - begin);
+  const auto compute = [&](const std::size_t& from, const std::size_t& to) {
+    for (auto i = from; i < to && !is_stale(generation); ++i) {
+      results[i] = compute_cell(page, cells[begin + i]);
+    }
+  };
+  if (m_thread_pool == nullptr || results.size() < PARALLEL_LEVEL_MIN) {
+    compute(0, results.size());
+  } else {
+    m_thread_pool->parallel_for(results.size(), compute);
+  }
+  return results;
+}
+
+auto State::compute_cell(const Page& page, const CellPos& pos) noexcept
+    -> std::optional<DataCell> {
+  const auto data_cell = page.get_cell(pos);
+  if (data_cell == nullptr) {
+    return std::nullopt;
+  }
+  const auto content = data_cell->get_raw_content();
+  const auto formula = data_cell->get_formula()
+                           ? data_cell->get_formula()
+                           : Formula::compile(content, pos);
+  const auto obj = formula->evaluate(page, pos);
+  return DataCell{content, obj, formula};
+}
+
+auto State::mark_outdated(const DependenciesHandler::RecalcPlan& plan,
+                          const CellPos& changed_pos,
+                          DependenciesHandler::CellPosSet& outdated) noexcept
+    -> void {
+  const auto affected_it = plan.affected.find(changed_pos);
+  if (affected_it == plan.affected.cend()) return;
+  outdated.insert(affected_it->second.cbegin(), affected_it->second.cend());
+}
+
+auto State::take_outdated(const std::vector<CellPos>& level,
+                          DependenciesHandler::CellPosSet& outdated) noexcept
+    -> std::vector<CellPos> {
+  std::vector<CellPos> cells{};
+  for (const auto& pos : level) {
+    if (outdated.erase(pos) > 0) {
+      cells.push_back(pos);
+    }
+  }
+  return cells;
+}
+
+auto State::value_changed(const Page& page,
+                          const CellPos& pos,
+                          const MytValue& value) noexcept -> bool {
+  const auto data_cell = page.get_cell(pos);
+  return data_cell == nullptr || data_cell->get_value() != value;
 }
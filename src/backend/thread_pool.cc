@@ -0,0 +1,127 @@
+#include "../../include/backend/thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(const std::size_t& n_workers)
+    : m_queues(), m_workers(), m_wake_mutex(), m_wake() {
+  const auto n = std::max<std::size_t>(n_workers, 1);
+  m_queues.reserve(n);
+  for (std::size_t i{0}; i < n; ++i) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+  m_workers.reserve(n);
+  for (std::size_t i{0}; i < n; ++i) {
+    m_workers.emplace_back([this, i] { worker_loop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    const std::lock_guard<std::mutex> lock{m_wake_mutex};
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+auto ThreadPool::parallel_for(const std::size_t& n, const RangeFn& fn) noexcept
+    -> void {
+  if (n == 0) {
+    return;
+  }
+  const auto max_chunks = m_workers.size() * CHUNKS_PER_WORKER;
+  const auto chunk_size = (n + max_chunks - 1) / max_chunks;
+  const auto n_chunks = (n + chunk_size - 1) / chunk_size;
+
+  // Chunks decrement `remaining` under `done_mutex`, so once the caller sees
+  // zero no task touches this stack frame anymore
+  std::mutex done_mutex{};
+  std::condition_variable done{};
+  std::size_t remaining{n_chunks};
+
+  for (std::size_t chunk{0}; chunk < n_chunks; ++chunk) {
+    const auto begin = chunk * chunk_size;
+    const auto end = std::min(n, begin + chunk_size);
+    submit(chunk % m_queues.size(), [&, begin, end] {
+      fn(begin, end);
+      const std::lock_guard<std::mutex> lock{done_mutex};
+      if (--remaining == 0) {
+        done.notify_all();
+      }
+    });
+  }
+
+  Task task{};
+  while (try_steal(m_queues.size(), task)) {
+    task();
+  }
+  std::unique_lock<std::mutex> lock{done_mutex};
+  done.wait(lock, [&remaining] { return remaining == 0; });
+}
+
+auto ThreadPool::submit(const std::size_t& worker_idx, Task&& task) noexcept
+    -> void {
+  {
+    auto& queue = *m_queues[worker_idx];
+    const std::lock_guard<std::mutex> lock{queue.mutex};
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    const std::lock_guard<std::mutex> lock{m_wake_mutex};
+    m_pending.fetch_add(1);
+  }
+  m_wake.notify_one();
+}
+
+auto ThreadPool::try_pop(const std::size_t& worker_idx, Task& task) noexcept
+    -> bool {
+  auto& queue = *m_queues[worker_idx];
+  const std::lock_guard<std::mutex> lock{queue.mutex};
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  m_pending.fetch_sub(1);
+  return true;
+}
+
+auto ThreadPool::try_steal(const std::size_t& thief_idx, Task& task) noexcept
+    -> bool {
+  const auto n_queues = m_queues.size();
+  for (std::size_t i{1}; i <= n_queues; ++i) {
+    const auto victim_idx = (thief_idx + i) % n_queues;
+    if (victim_idx == thief_idx) {
+      continue;
+    }
+    auto& queue = *m_queues[victim_idx];
+    const std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    m_pending.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+auto ThreadPool::worker_loop(const std::size_t& worker_idx) noexcept -> void {
+  Task task{};
+  while (true) {
+    if (try_pop(worker_idx, task) || try_steal(worker_idx, task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock{m_wake_mutex};
+    m_wake.wait(lock, [this] { return m_stop || m_pending.load() > 0; });
+    if (m_stop && m_pending.load() == 0) {
+      return;
+    }
+  }
+}
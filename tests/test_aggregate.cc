@@ -0,0 +1,218 @@
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../extern/include/catch.hpp"
+#include "backend/data_cell.hpp"
+#include "backend/myt_lang/aggregate.hpp"
+#include "backend/myt_lang/cell_pos.hpp"
+#include "backend/myt_lang/evaluator.hpp"
+#include "backend/myt_lang/lexer.hpp"
+#include "backend/myt_lang/myt_object.hpp"
+#include "backend/myt_lang/parser.hpp"
+#include "backend/page.hpp"
+
+TEST_CASE("Aggregate Call Expressions to Values") {
+  using testCases = std::vector<std::tuple<std::string, std::string>>;
+
+  Page page{};
+  page.save_cell(DataCell{"= 4", std::make_shared<ValueObject<int>>(4)},
+                 CellPos{"A1"});
+  page.save_cell(
+      DataCell{"= 1.5", std::make_shared<ValueObject<FloatType>>(1.5)},
+      CellPos{"A3"});
+  page.save_cell(
+      DataCell{"= \"x\"", std::make_shared<ValueObject<std::string>>("x")},
+      CellPos{"A4"});
+  page.save_cell(DataCell{"= true", std::make_shared<ValueObject<bool>>(true)},
+                 CellPos{"A5"});
+  page.save_cell(DataCell{"= -2", std::make_shared<ValueObject<int>>(-2)},
+                 CellPos{"A300"});
+
+  testCases cases = {
+      {"= Avg(1, 2)", "1.500000"},
+      {"= Avg(A1:A300)", "1.166667"},
+      {"= Avg(A4:A5)", "Error: Can't divide by 0"},
+      {"= Min(3, 1, 2)", "1"},
+      {"= Min(A1:A300)", "-2.000000"},
+      {"= Min(A1:A3, 7)", "1.500000"},
+      {"= Max(3, 1, 2)", "3"},
+      {"= Max(A1:A300, 2.0)", "4.000000"},
+      {"= Max(A2:A2)", "0"},
+      {"= Count(A1:A300)", "3"},
+      {"= Count(1, \"a\", true, 2.0)", "2"},
+      {"= Count(C1:C65000)", "0"},
+      {"= Product(2, 3, 4)", "24"},
+      {"= Product(A1:A300)", "-12.000000"},
+      {"= Product(2, 0.5)", "1.000000"},
+      {"= Product(65536, 65536)", "4294967296.000000"},
+      {"= Sum(2147483647, 1)", "2147483648.000000"},
+      {"= Sum(A1:A300, 0.5)", "4.000000"},
+  };
+
+  for (const auto& [input, target] : cases) {
+    const auto parsed = Parser::parse(Lexer::tokenize(input));
+    INFO(input);
+    CHECK(Evaluator::evaluate_value(parsed, page).to_string() == target);
+  }
+}
+
+TEST_CASE("Aggregate kernels match the scalar fold on every isa") {
+  using Op = Aggregate::Op;
+  using testCases = std::vector<std::tuple<CellPos, CellPos>>;
+
+  // Dense ints in A, sparse floats, strings and bools in B, C stays empty
+  Page page{};
+  for (CellLimitType row{1}; row <= 1000; ++row) {
+    const auto value = static_cast<int>(row % 97) - 40;
+    page.save_cell(
+        DataCell{"= " + std::to_string(value),
+                 std::make_shared<ValueObject<int>>(value)},
+        CellPos{1, row});
+    if (row % 3 == 0) {
+      const auto number = static_cast<FloatType>(row) * 0.25f - 60.0f;
+      page.save_cell(
+          DataCell{"= " + std::to_string(number),
+                   std::make_shared<ValueObject<FloatType>>(number)},
+          CellPos{2, row});
+    } else if (row % 7 == 0) {
+      page.save_cell(
+          DataCell{"= \"s\"", std::make_shared<ValueObject<std::string>>("s")},
+          CellPos{2, row});
+    } else if (row % 11 == 0) {
+      page.save_cell(
+          DataCell{"= true", std::make_shared<ValueObject<bool>>(true)},
+          CellPos{2, row});
+    }
+  }
+
+  testCases cases = {
+      {CellPos{"A1"}, CellPos{"A1000"}},   {CellPos{"A3"}, CellPos{"A700"}},
+      {CellPos{"A256"}, CellPos{"A257"}},  {CellPos{"B1"}, CellPos{"B1000"}},
+      {CellPos{"A200"}, CellPos{"C900"}},  {CellPos{"A1"}, CellPos{"A1"}},
+      {CellPos{"C1"}, CellPos{"C50"}},     {CellPos{"B2"}, CellPos{"B3"}},
+  };
+
+  const auto ops = {Op::Sum, Op::Avg, Op::Min, Op::Max, Op::Count};
+  for (const auto& [begin, end] : cases) {
+    const auto range_str = begin.to_string() + ":" + end.to_string();
+    const auto view = MytValue::from_object(
+        std::make_shared<CellRangeObject>(range_str, page, begin, end));
+    const auto detached = CellRangeObject::detach(view);
+    for (const auto& op : ops) {
+      const auto expected =
+          Aggregate::fold(op, {detached}, Aggregate::Isa::Scalar);
+      for (const auto& isa : Aggregate::supported()) {
+        const auto got = Aggregate::fold(op, {view}, isa);
+        INFO(range_str + " op " + std::to_string(static_cast<int>(op)) +
+             " isa " + std::to_string(static_cast<int>(isa)));
+        CHECK(got.tag() == expected.tag());
+        CHECK(got.get_number() == Approx(expected.get_number()));
+      }
+    }
+  }
+}
+
+TEST_CASE("Aggregate sums are compensated") {
+  // A float accumulator drifts to 999.9 here
+  Page page{};
+  for (CellLimitType row{1}; row <= 10000; ++row) {
+    page.save_cell(
+        DataCell{"= 0.1", std::make_shared<ValueObject<FloatType>>(0.1f)},
+        CellPos{1, row});
+  }
+  const auto view = MytValue::from_object(std::make_shared<CellRangeObject>(
+      "A1:A10000", page, CellPos{"A1"}, CellPos{"A10000"}));
+  const auto target = static_cast<FloatType>(10000.0 * double{0.1f});
+
+  for (const auto& isa : Aggregate::supported()) {
+    INFO(static_cast<int>(isa));
+    CHECK(Aggregate::fold(Aggregate::Op::Sum, {view}, isa).get_float() ==
+          target);
+  }
+  const auto cancel = std::vector<MytValue>{
+      MytValue::from_float(1e8f),
+      MytValue::from_float(1.0f),
+      MytValue::from_float(-1e8f),
+  };
+  CHECK(Aggregate::fold(Aggregate::Op::Sum, cancel).get_float() == 1.0f);
+}
+
+TEST_CASE("Indexed columns match the block scan") {
+  using Op = Aggregate::Op;
+  using testCases = std::vector<std::tuple<CellPos, CellPos>>;
+
+  std::mt19937 rng{7};
+  const auto next = [&rng](const uint32_t& bound) { return rng() % bound; };
+  const auto random_cell = [&next]() {
+    const auto value = static_cast<int>(next(2000)) - 1000;
+    switch (next(4)) {
+      case 0:
+        return DataCell{"= \"s\"",
+                        std::make_shared<ValueObject<std::string>>("s")};
+      case 1:
+        return DataCell{"= 0.5", std::make_shared<ValueObject<FloatType>>(
+                                     static_cast<FloatType>(value) * 0.5f)};
+      default:
+        return DataCell{"= 1", std::make_shared<ValueObject<int>>(value)};
+    }
+  };
+
+  Page scanned{};
+  for (uint32_t i{0}; i < 3000; ++i) {
+    const auto pos = CellPos{static_cast<CellLimitType>(1 + next(2)),
+                             static_cast<CellLimitType>(1 + next(5000))};
+    scanned.save_cell(random_cell(), pos);
+  }
+  auto indexed = scanned;
+  indexed.set_aggregate_index(1, true);
+  indexed.set_aggregate_index(2, true);
+  // Edits after indexing, a snapshot keeps the index it was copied with
+  const auto snapshot = indexed;
+  for (uint32_t i{0}; i < 400; ++i) {
+    const auto pos = CellPos{static_cast<CellLimitType>(1 + next(2)),
+                             static_cast<CellLimitType>(1 + next(5000))};
+    if (next(3) == 0) {
+      scanned.erase_cell(pos);
+      indexed.erase_cell(pos);
+    } else {
+      const auto data_cell = random_cell();
+      scanned.save_cell(data_cell, pos);
+      indexed.save_cell(data_cell, pos);
+    }
+  }
+  REQUIRE(indexed.get_aggregate_index(1) != nullptr);
+  REQUIRE(snapshot.get_aggregate_index(1) != nullptr);
+  CHECK(indexed.get_aggregate_index(1) != snapshot.get_aggregate_index(1));
+  CHECK(scanned.get_aggregate_index(1) == nullptr);
+
+  testCases cases = {
+      {CellPos{"A1"}, CellPos{"A5000"}},  {CellPos{"A1"}, CellPos{"A256"}},
+      {CellPos{"A257"}, CellPos{"A768"}}, {CellPos{"A100"}, CellPos{"B4000"}},
+      {CellPos{"B300"}, CellPos{"B310"}}, {CellPos{"A1"}, CellPos{"A65000"}},
+      {CellPos{"B2"}, CellPos{"B2000"}},  {CellPos{"C1"}, CellPos{"C999"}},
+  };
+
+  const auto ops = {Op::Sum, Op::Avg, Op::Min, Op::Max, Op::Count};
+  const auto fold = [](const Op& op, const Page& page, const CellPos& begin,
+                       const CellPos& end) {
+    return Aggregate::fold(
+        op, {MytValue::from_object(std::make_shared<CellRangeObject>(
+                begin.to_string() + ":" + end.to_string(), page, begin, end))});
+  };
+  for (const auto& [begin, end] : cases) {
+    for (const auto& op : ops) {
+      const auto expected = fold(op, scanned, begin, end);
+      const auto got = fold(op, indexed, begin, end);
+      INFO(begin.to_string() + ":" + end.to_string() + " op " +
+           std::to_string(static_cast<int>(op)));
+      CHECK(got.tag() == expected.tag());
+      CHECK(got.to_string() == expected.to_string());
+    }
+  }
+
+  indexed.set_aggregate_index(1, false);
+  CHECK(indexed.get_aggregate_index(1) == nullptr);
+}
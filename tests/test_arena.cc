@@ -0,0 +1,41 @@
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "../extern/include/catch.hpp"
+#include "backend/myt_lang/arena.hpp"
+
+TEST_CASE("Arena allocations") {
+  using testCases = std::vector<std::tuple<std::size_t, std::size_t>>;
+
+  // Sizes and alignments mixed so every block boundary gets crossed
+  testCases cases{
+      {1, 1}, {8, 8}, {3, 1}, {16, 16}, {100, 4}, {24, 8}, {5000, 8}, {2, 2},
+  };
+
+  Arena arena{};
+  std::vector<std::tuple<unsigned char*, std::size_t>> allocations{};
+  for (std::size_t round{0}; round < 64; ++round) {
+    for (const auto& [size, align] : cases) {
+      const auto ptr = static_cast<unsigned char*>(arena.allocate(size, align));
+      CHECK(reinterpret_cast<std::uintptr_t>(ptr) % align == 0);
+      for (std::size_t i{0}; i < size; ++i) {
+        ptr[i] = static_cast<unsigned char>(allocations.size());
+      }
+      allocations.emplace_back(ptr, size);
+    }
+  }
+
+  // Nothing got overwritten by later allocations
+  bool intact{true};
+  for (std::size_t idx{0}; idx < allocations.size(); ++idx) {
+    const auto& [ptr, size] = allocations[idx];
+    for (std::size_t i{0}; i < size; ++i) {
+      intact = intact && ptr[i] == static_cast<unsigned char>(idx);
+    }
+  }
+  CHECK(intact);
+  // Blocks grow, so the count stays logarithmic in the bytes requested
+  CHECK(arena.block_count() < 16);
+}
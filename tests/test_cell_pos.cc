@@ -1,5 +1,6 @@
 #include <string>
 #include <tuple>
+#include <unordered_set>
 #include <vector>
 
 #include "../extern/include/catch.hpp"
@@ -34,3 +35,45 @@ TEST_CASE("Converting string cell pos to row/col pos") {
     }
   }
 }
+
+TEST_CASE("Converting invalid string cell pos") {
+  using testCases = std::vector<std::string>;
+
+  testCases cases{"A0", "A65535", "A99999999999999999999", "CRXP1", "ZZZZ1",
+                  "AAAAAAAAAAAAAAAA1"};
+
+  for (const auto& input : cases) {
+    CHECK_THROWS_AS(CellPos(input), InvalidCellString);
+  }
+}
+
+TEST_CASE("Converting cell pos to string") {
+  using testCases = std::vector<std::tuple<CellPos, std::string>>;
+
+  testCases cases{
+      {CellPos{1, 1}, "A1"},         {CellPos{26, 55}, "Z55"},
+      {CellPos{27, 10}, "AA10"},     {CellPos{702, 100}, "ZZ100"},
+      {CellPos{703, 9}, "AAA9"},     {CellPos{65534, 65534}, "CRXN65534"},
+  };
+
+  for (const auto& [pos, target] : cases) {
+    CHECK(pos.to_string() == target);
+    CHECK(CellPos(target) == pos);
+  }
+}
+
+TEST_CASE("Cell pos key and hash") {
+  // A dense block must round trip and not pile up in a few buckets
+  constexpr std::size_t n_buckets = 4096;
+  std::unordered_set<std::size_t> buckets{};
+  bool round_trips{true};
+  for (CellLimitType col{1}; col <= 64; ++col) {
+    for (CellLimitType row{1}; row <= 64; ++row) {
+      const auto pos = CellPos{col, row};
+      round_trips &= CellPos::from_key(pos.key()) == pos;
+      buckets.insert(std::hash<CellPos>{}(pos) % n_buckets);
+    }
+  }
+  CHECK(round_trips);
+  CHECK(buckets.size() > n_buckets / 2);
+}
@@ -1,5 +1,7 @@
 #include <qobject.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -7,6 +9,8 @@
 #include "../extern/include/catch.hpp"
 #include "backend/cell_dependencies_handler.hpp"
 #include "backend/myt_lang/cell_pos.hpp"
+#include "backend/myt_lang/lexer.hpp"
+#include "backend/myt_lang/parser.hpp"
 #include "backend/state.hpp"
 
 using Dependencies = DependenciesHandler::Dependencies;
@@ -168,6 +172,26 @@ TEST_CASE("Dependencies updates") {
           Dependencies{},
           Dependencies{},
       },
+      {
+          // Untaken branches of lazy builtins are still dependencies
+          cellInputs{
+              {"= If(B1, C1, Sum(D1:D2))", CellPos{"A1"}},
+              {"= IfError(B1, Choose(2, C2, C3))", CellPos{"A2"}},
+          },
+          Dependencies{
+              {CellPos{"B1"}, {CellPos{"A1"}, CellPos{"A2"}}},
+              {CellPos{"C1"}, {CellPos{"A1"}}},
+              {CellPos{"D1"}, {CellPos{"A1"}}},
+              {CellPos{"D2"}, {CellPos{"A1"}}},
+              {CellPos{"C2"}, {CellPos{"A2"}}},
+              {CellPos{"C3"}, {CellPos{"A2"}}},
+          },
+          Dependencies{
+              {CellPos{"A1"},
+               {CellPos{"B1"}, CellPos{"C1"}, CellPos{"D1"}, CellPos{"D2"}}},
+              {CellPos{"A2"}, {CellPos{"B1"}, CellPos{"C2"}, CellPos{"C3"}}},
+          },
+      },
   };
 
   for (auto& [inputs, deps_affected, deps_uses] : cases) {
@@ -209,6 +233,19 @@ TEST_CASE("Dependencies cycle detection") {
               {CellPos{"A1"}, {CellPos{"A4"}}},
           },
       },
+      {
+          cellInputs{
+              {"=C1", CellPos{"D1"}},
+              {"=Sum(B1:B3)", CellPos{"A1"}},
+              {"=A1", CellPos{"B2"}},
+          },
+          Dependencies{
+              {CellPos{"C1"}, {CellPos{"D1"}}},
+          },
+          Dependencies{
+              {CellPos{"D1"}, {CellPos{"C1"}}},
+          },
+      },
   };
 
   for (auto& [inputs, deps_affected, deps_uses] : cases) {
@@ -221,3 +258,468 @@ TEST_CASE("Dependencies cycle detection") {
     CHECK(state.get_dependencies_uses() == deps_uses);
   }
 }
+
+TEST_CASE("Dependencies recalculation order") {
+  using cellInputs = std::vector<std::tuple<std::string, CellPos>>;
+  using testCases = std::vector<std::tuple<cellInputs, CellPos>>;
+
+  testCases cases = {
+      {
+          cellInputs{
+              {"=A1+1", CellPos{"B1"}},
+              {"=A1*2", CellPos{"B2"}},
+              {"=A1-3", CellPos{"B3"}},
+              {"=Sum(B1:B3)", CellPos{"C1"}},
+              {"=C1+B2", CellPos{"D1"}},
+          },
+          CellPos{"A1"},
+      },
+      {
+          cellInputs{
+              {"=A1", CellPos{"A2"}},
+              {"=A2", CellPos{"A3"}},
+              {"=A3+A1", CellPos{"A4"}},
+              {"=B1", CellPos{"A5"}},
+          },
+          CellPos{"A1"},
+      },
+  };
+
+  for (const auto& [inputs, edited_pos] : cases) {
+    DependenciesHandler handler{};
+    for (const auto& [input, pos] : inputs) {
+      const auto tokens = Lexer::tokenize(input);
+      handler.update_dependencies(pos, Parser::parse(tokens));
+    }
+    const auto order = handler.get_recalc_order({edited_pos});
+    const auto index_of = [&order](const CellPos& pos) {
+      return std::find(order.cbegin(), order.cend(), pos) - order.cbegin();
+    };
+
+    const auto levels = handler.get_recalc_levels({edited_pos});
+    const auto level_of = [&levels](const CellPos& pos) {
+      for (std::size_t i{0}; i < levels.size(); ++i) {
+        if (std::find(levels[i].cbegin(), levels[i].cend(), pos) !=
+            levels[i].cend()) {
+          return i;
+        }
+      }
+      return levels.size();
+    };
+
+    const auto dependencies = handler.get_dependencies();
+    for (const auto& pos : order) {
+      CHECK(std::count(order.cbegin(), order.cend(), pos) == 1);
+      for (const auto& [used_pos, affected] : dependencies) {
+        if (affected.find(pos) != affected.cend() && used_pos != edited_pos) {
+          CHECK(index_of(used_pos) < index_of(pos));
+          CHECK(level_of(used_pos) < level_of(pos));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Dependencies recalculation plan") {
+  using affectedTargets = std::vector<CellPos>;
+  using testCases = std::vector<std::tuple<CellPos, affectedTargets>>;
+
+  DependenciesHandler handler{};
+  const auto inputs = std::vector<std::tuple<std::string, CellPos>>{
+      {"=A1+1", CellPos{"B1"}}, {"=A1*2", CellPos{"B2"}},
+      {"=B1+B2", CellPos{"C1"}}, {"=Sum(C1:C2)", CellPos{"D1"}},
+      {"=Z9", CellPos{"E1"}},
+  };
+  for (const auto& [input, pos] : inputs) {
+    handler.update_dependencies(pos, Parser::parse(Lexer::tokenize(input)));
+  }
+  const auto plan = handler.get_recalc_plan({CellPos{"A1"}});
+  CHECK(plan.levels == handler.get_recalc_levels({CellPos{"A1"}}));
+
+  testCases cases = {
+      {CellPos{"A1"}, {CellPos{"B1"}, CellPos{"B2"}}},
+      {CellPos{"B1"}, {CellPos{"C1"}}},
+      {CellPos{"B2"}, {CellPos{"C1"}}},
+      {CellPos{"C1"}, {CellPos{"D1"}}},
+      {CellPos{"D1"}, {}},
+  };
+  for (const auto& [pos, target] : cases) {
+    const auto affected_it = plan.affected.find(pos);
+    REQUIRE(affected_it != plan.affected.cend());
+    auto affected = affected_it->second;
+    std::sort(affected.begin(), affected.end());
+    CHECK(affected == target);
+  }
+  CHECK(plan.affected.find(CellPos{"E1"}) == plan.affected.cend());
+}
+
+TEST_CASE("Dependencies recalculation values") {
+  using cellInputs = std::vector<std::tuple<std::string, CellPos>>;
+  using targets = std::vector<std::tuple<CellPos, std::string>>;
+  using testCases = std::vector<std::tuple<cellInputs, targets>>;
+
+  testCases cases = {
+      {
+          cellInputs{
+              {"=1", CellPos{"A1"}},
+              {"=A1+1", CellPos{"B1"}},
+              {"=A1*2", CellPos{"B2"}},
+              {"=Sum(B1:B2)", CellPos{"C1"}},
+              {"=5", CellPos{"A1"}},
+          },
+          targets{
+              {CellPos{"B1"}, "6"},
+              {CellPos{"B2"}, "10"},
+              {CellPos{"C1"}, "16"},
+          },
+      },
+  };
+
+  cellInputs chain{{"=0", CellPos{1, 1}}};
+  constexpr CellLimitType chain_len = 10000;
+  for (CellLimitType row{2}; row <= chain_len; ++row) {
+    const auto prev = CellPos{1, static_cast<CellLimitType>(row - 1)};
+    chain.emplace_back("=" + prev.to_string() + "+1", CellPos{1, row});
+  }
+  chain.emplace_back("=1", CellPos{1, 1});
+  cases.emplace_back(chain, targets{{CellPos{1, chain_len}, "10000"}});
+
+  // Running totals, every cell of column B sums a growing range of column A
+  cellInputs totals{};
+  constexpr CellLimitType totals_len = 300;
+  for (CellLimitType row{1}; row <= totals_len; ++row) {
+    const auto last = CellPos{1, row};
+    totals.emplace_back("=1", last);
+    totals.emplace_back("=Sum(A1:" + last.to_string() + ")", CellPos{2, row});
+  }
+  totals.emplace_back("=101", CellPos{1, 1});
+  cases.emplace_back(totals, targets{
+                                 {CellPos{2, 1}, "101"},
+                                 {CellPos{2, totals_len}, "400"},
+                             });
+
+  // Wide fan out, the level below A1 is large enough to go parallel
+  cellInputs fan_out{};
+  constexpr CellLimitType fan_out_len = 500;
+  for (CellLimitType row{1}; row <= fan_out_len; ++row) {
+    fan_out.emplace_back("=A1*" + std::to_string(row), CellPos{2, row});
+  }
+  fan_out.emplace_back("=Sum(B1:B500)", CellPos{3, 1});
+  fan_out.emplace_back("=2", CellPos{1, 1});
+  cases.emplace_back(fan_out, targets{
+                                  {CellPos{2, 1}, "2"},
+                                  {CellPos{2, fan_out_len}, "1000"},
+                                  {CellPos{3, 1}, "250500"},
+                              });
+
+  // Early cutoff, B1 keeps its value while B2 still reaches C1
+  cases.emplace_back(
+      cellInputs{
+          {"=5", CellPos{"A1"}},
+          {"=If(A1 > 100, 1, 0)", CellPos{"B1"}},
+          {"=A1*2", CellPos{"B2"}},
+          {"=B1+B2", CellPos{"C1"}},
+          {"=C1+1", CellPos{"D1"}},
+          {"=7", CellPos{"A1"}},
+          {"=7", CellPos{"A1"}},
+      },
+      targets{
+          {CellPos{"B1"}, "0"},
+          {CellPos{"C1"}, "14"},
+          {CellPos{"D1"}, "15"},
+      });
+  cases.emplace_back(
+      cellInputs{
+          {"=5", CellPos{"A1"}},
+          {"=If(A1 > 100, 1, 0)", CellPos{"B1"}},
+          {"=B1+1", CellPos{"C1"}},
+          {"=700", CellPos{"A1"}},
+          {"=600", CellPos{"A1"}},
+          {"=5.0", CellPos{"A2"}},
+          {"=A2", CellPos{"B2"}},
+          {"=5", CellPos{"A2"}},
+      },
+      targets{
+          {CellPos{"C1"}, "2"},
+          {CellPos{"B2"}, "5"},
+      });
+
+  // Sequential, parallel levels and background recalculation
+  const auto configs = std::vector<std::tuple<std::size_t, bool>>{
+      {0, false},
+      {4, false},
+      {4, true},
+  };
+  for (const auto& [n_workers, is_async] : configs) {
+    for (const auto& [inputs, expected] : cases) {
+      State state{};
+      state.set_recalc_workers(n_workers);
+      state.set_async_recalc(is_async);
+      for (const auto& [input, pos] : inputs) {
+        const auto q_input = QString::fromStdString(input);
+        state.eval_save(q_input, pos.col, pos.row);
+      }
+      state.wait_for_recalc();
+      for (const auto& [pos, target] : expected) {
+        const auto content = state.get_content_by_pos(pos.col, pos.row);
+        CHECK(content.toStdString() == target);
+      }
+    }
+  }
+}
+
+TEST_CASE("Dependencies through cell ranges") {
+  using affectedTargets =
+      std::vector<std::tuple<CellPos, std::vector<CellPos>>>;
+  using cellInputs = std::vector<std::tuple<std::string, CellPos>>;
+  using testCases = std::vector<std::tuple<cellInputs, affectedTargets>>;
+
+  testCases cases = {
+      {
+          cellInputs{{"=Sum(A1:A60000)", CellPos{"B1"}}},
+          affectedTargets{
+              {CellPos{"A1"}, {CellPos{"B1"}}},
+              {CellPos{"A60000"}, {CellPos{"B1"}}},
+              {CellPos{"A60001"}, {}},
+              {CellPos{"B2"}, {}},
+          },
+      },
+      {
+          cellInputs{
+              {"=Sum(A1:CZ3)", CellPos{"A10"}},
+              {"=Sum(BL2:BL2, BL2)", CellPos{"A11"}},
+              {"=Sum(C3:C5)", CellPos{"A12"}},
+          },
+          affectedTargets{
+              {CellPos{"CZ3"}, {CellPos{"A10"}}},
+              {CellPos{"BL2"}, {CellPos{"A10"}, CellPos{"A11"}}},
+              {CellPos{"C3"}, {CellPos{"A10"}, CellPos{"A12"}}},
+              {CellPos{"C4"}, {CellPos{"A12"}}},
+              {CellPos{"DA3"}, {}},
+          },
+      },
+      {
+          cellInputs{
+              {"=Sum(A1:A5)", CellPos{"B1"}},
+              {"=Sum(A4:A9)", CellPos{"B2"}},
+              {"=A1", CellPos{"B1"}},
+          },
+          affectedTargets{
+              {CellPos{"A1"}, {CellPos{"B1"}}},
+              {CellPos{"A2"}, {}},
+              {CellPos{"A4"}, {CellPos{"B2"}}},
+          },
+      },
+  };
+
+  for (const auto& [inputs, expected] : cases) {
+    DependenciesHandler handler{};
+    for (const auto& [input, pos] : inputs) {
+      const auto tokens = Lexer::tokenize(input);
+      handler.update_dependencies(pos, Parser::parse(tokens));
+    }
+    for (const auto& [pos, target] : expected) {
+      const auto affected = handler.get_affected_positions(pos);
+      const auto target_set =
+          DependenciesHandler::CellPosSet{target.cbegin(), target.cend()};
+      CHECK(affected.value_or(DependenciesHandler::CellPosSet{}) == target_set);
+    }
+  }
+}
+
+TEST_CASE("Dependencies superseded background recalculation") {
+  using cellInputs = std::vector<std::tuple<std::string, CellPos>>;
+  using targets = std::vector<std::tuple<CellPos, std::string>>;
+  using testCases = std::vector<std::tuple<cellInputs, targets>>;
+
+  constexpr CellLimitType fan_out_len = 20000;
+  const auto last = CellPos{2, fan_out_len};
+  testCases cases = {
+      // A newer edit of the same cell wins
+      {
+          cellInputs{{"=2", CellPos{"A1"}}, {"=3", CellPos{"A1"}}},
+          targets{{CellPos{"B1"}, "3"}, {last, "60000"}},
+      },
+      // An unrelated edit must not lose the pending dependents of A1
+      {
+          cellInputs{{"=2", CellPos{"A1"}}, {"=7", CellPos{"C1"}}},
+          targets{{CellPos{"B1"}, "2"}, {last, "40000"}, {CellPos{"C1"}, "7"}},
+      },
+      {
+          cellInputs{
+              {"=2", CellPos{"A1"}},
+              {"=A1+1", CellPos{"B1"}},
+              {"=4", CellPos{"A1"}},
+          },
+          targets{{CellPos{"B1"}, "5"}, {CellPos{"B2"}, "8"}},
+      },
+  };
+
+  for (const auto& [inputs, expected] : cases) {
+    State state{};
+    state.set_recalc_workers(4);
+    state.set_async_recalc(true);
+    for (CellLimitType row{1}; row <= fan_out_len; ++row) {
+      const auto input = "=A1*" + std::to_string(row);
+      state.eval_save(QString::fromStdString(input), 2, row);
+    }
+    state.wait_for_recalc();
+    for (const auto& [input, pos] : inputs) {
+      const auto q_input = QString::fromStdString(input);
+      state.eval_save(q_input, pos.col, pos.row);
+    }
+    // Replacing the workers of the running recalculation
+    state.set_recalc_workers(2);
+    state.wait_for_recalc();
+    for (const auto& [pos, target] : expected) {
+      const auto content = state.get_content_by_pos(pos.col, pos.row);
+      CHECK(content.toStdString() == target);
+    }
+  }
+}
+
+TEST_CASE("Dependencies viewport first recalculation") {
+  using viewport = std::tuple<CellLimitType, CellLimitType, CellLimitType,
+                              CellLimitType>;
+  using cellInputs = std::vector<std::tuple<std::string, CellPos>>;
+  using targets = std::vector<std::tuple<CellPos, std::string>>;
+  using testCases = std::vector<std::tuple<viewport, cellInputs, targets>>;
+
+  // A chain down column A, column B reads A1 and the chain end, C1 sums B
+  constexpr CellLimitType len = 3000;
+  const auto chain_end = CellPos{1, len};
+  cellInputs sheet{{"=0", CellPos{1, 1}}};
+  for (CellLimitType row{2}; row <= len; ++row) {
+    const auto prev = CellPos{1, static_cast<CellLimitType>(row - 1)};
+    sheet.emplace_back("=" + prev.to_string() + "+1", CellPos{1, row});
+  }
+  for (CellLimitType row{1}; row <= 500; ++row) {
+    sheet.emplace_back("=A1*" + std::to_string(row) + "+" +
+                           chain_end.to_string(),
+                       CellPos{2, row});
+  }
+  sheet.emplace_back("=Sum(B1:B500)", CellPos{3, 1});
+
+  const auto edit = cellInputs{{"=1", CellPos{1, 1}}};
+  const auto expected = targets{
+      {chain_end, "3000"},
+      {CellPos{2, 1}, "3001"},
+      {CellPos{2, 500}, "3500"},
+      {CellPos{3, 1}, "1625250"},
+      {CellPos{1, 1500}, "1500"},
+  };
+  testCases cases = {
+      // Visible cells read the whole chain from off screen
+      {viewport{0, 0, 11, 16}, edit, expected},
+      {viewport{1, 2990, 3, 20}, edit, expected},
+      {viewport{2, 400, 2, 200}, edit, expected},
+      // Empty and oversized viewports
+      {viewport{0, 0, 0, 0}, edit, expected},
+      {viewport{0, 0, 65535, 65535}, edit, expected},
+      // Edits inside the viewport keep unchanged cells
+      {viewport{0, 0, 11, 16},
+       cellInputs{{"=1", CellPos{1, 1}}, {"=0", CellPos{1, 1}}},
+       targets{{chain_end, "2999"}, {CellPos{3, 1}, "1499500"}}},
+  };
+
+  for (const auto& [view, inputs, targets] : cases) {
+    State state{};
+    state.set_recalc_workers(4);
+    state.set_async_recalc(true);
+    for (const auto& [input, pos] : sheet) {
+      state.eval_save(QString::fromStdString(input), pos.col, pos.row);
+    }
+    state.wait_for_recalc();
+    const auto& [col, row, cols, rows] = view;
+    state.set_viewport(col, row, cols, rows);
+    for (const auto& [input, pos] : inputs) {
+      state.eval_save(QString::fromStdString(input), pos.col, pos.row);
+      // Scrolling while the recalculation runs
+      state.set_viewport(col, static_cast<CellLimitType>(row / 2), cols, rows);
+    }
+    state.wait_for_recalc();
+    for (const auto& [pos, target] : targets) {
+      INFO(pos.to_string());
+      CHECK(state.get_content_by_pos(pos.col, pos.row).toStdString() ==
+            target);
+    }
+  }
+}
+
+TEST_CASE("Dependencies viewport cells are recalculated first") {
+  using viewport = std::tuple<CellLimitType, CellLimitType, CellLimitType,
+                              CellLimitType>;
+  using testCases = std::vector<std::tuple<viewport, viewport, CellPos>>;
+
+  // Column B reads A1, column C reads column B, both levels take several
+  // batches
+  constexpr CellLimitType len = 30000;
+  const auto top = viewport{3, 0, 1, 11};
+  const auto bottom = viewport{3, len - 10, 1, 11};
+  const auto in_view = [](const viewport& view, const CellPos& pos) {
+    const auto& [col, row, cols, rows] = view;
+    return pos.col >= col && pos.col < col + cols && pos.row >= row &&
+           pos.row < row + rows;
+  };
+  testCases cases = {
+      // Nothing else is recalculated before the visible cells
+      {top, top, CellPos{3, 10}},
+      // Scrolling during the recalculation, the new cells come next
+      {top, bottom, CellPos{3, len - 5}},
+  };
+
+  for (const auto& [first_view, scrolled_view, watched] : cases) {
+    State state{};
+    for (CellLimitType row{1}; row <= len; ++row) {
+      const auto b_input = "=A1*" + std::to_string(row);
+      const auto c_input = "=" + CellPos{2, row}.to_string() + "+1";
+      state.eval_save(QString::fromStdString(b_input), 2, row);
+      state.eval_save(QString::fromStdString(c_input), 3, row);
+    }
+    state.set_async_recalc(true);
+    std::vector<QList<int>> batches{};
+    QObject::connect(
+        &state, &State::requestCellsUpdate,
+        [&batches](const QList<int>& positions) {
+          batches.push_back(positions);
+        });
+
+    const auto& [col, row, cols, rows] = first_view;
+    state.set_viewport(col, row, cols, rows);
+    state.eval_save(QString::fromStdString("=2"), 1, 1);
+    const auto& [new_col, new_row, new_cols, new_rows] = scrolled_view;
+    state.set_viewport(new_col, new_row, new_cols, new_rows);
+    state.wait_for_recalc();
+
+    // Index of the first batch holding a cell matching `pred`
+    const auto first_batch = [&batches](const auto& pred) {
+      for (std::size_t idx{0}; idx < batches.size(); ++idx) {
+        for (std::size_t i{0}; i + 1 < batches[idx].size(); i += 2) {
+          const auto pos =
+              CellPos{static_cast<CellLimitType>(batches[idx][i]),
+                      static_cast<CellLimitType>(batches[idx][i + 1])};
+          if (pred(pos)) return idx;
+        }
+      }
+      return batches.size();
+    };
+    const auto hidden = [&](const CellPos& pos) {
+      return !in_view(first_view, pos) && !in_view(scrolled_view, pos);
+    };
+    const auto watched_batch =
+        first_batch([&](const CellPos& pos) { return pos == watched; });
+    // Hidden column C cells come last in level order
+    const auto hidden_batch = first_batch(
+        [&](const CellPos& pos) { return pos.col == 3 && hidden(pos); });
+    REQUIRE(watched_batch < batches.size());
+    CHECK(watched_batch < hidden_batch);
+    if (first_view == scrolled_view) {
+      // Only visible cells and the column B cells they read come first
+      CHECK(first_batch([&](const CellPos& pos) {
+              return hidden(pos) && hidden(CellPos{3, pos.row});
+            }) > 0);
+    }
+    CHECK(state.get_content_by_pos(watched.col, watched.row).toStdString() ==
+          std::to_string(2 * watched.row + 1));
+  }
+}
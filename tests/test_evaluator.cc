@@ -1,5 +1,7 @@
 #include <memory>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include "../extern/include/catch.hpp"
 #include "backend/data_cell.hpp"
@@ -22,7 +24,7 @@ struct StringMaker<MytObject> {
 TEST_CASE("Basic Value Objects") {
   using inputType = std::string;
   using targetType = MytObjectPtr;
-  using testCases = std::vector<std::tuple<inputType, targetType, CellMap>>;
+  using testCases = std::vector<std::tuple<inputType, targetType, Page>>;
 
   testCases cases{};
   cases.emplace_back("= 5", std::make_unique<ValueObject<int>>(5), CellMap{});
@@ -38,10 +40,10 @@ TEST_CASE("Basic Value Objects") {
       CellMap{{CellPos{"B22"},
                DataCell{"= true", std::make_unique<ValueObject<bool>>(true)}}});
 
-  for (const auto& [input, target, cells] : cases) {
+  for (const auto& [input, target, page] : cases) {
     const auto tokens = Lexer::tokenize(input);
     const auto parsed = Parser::parse(tokens);
-    const auto evaluated = Evaluator::evaluate(parsed, cells);
+    const auto evaluated = Evaluator::evaluate(parsed, page);
     CHECK(*evaluated == *target);
   }
 }
@@ -49,7 +51,7 @@ TEST_CASE("Basic Value Objects") {
 TEST_CASE("Prefix Expressions to Objects") {
   using inputType = std::string;
   using targetType = MytObjectPtr;
-  using testCases = std::vector<std::tuple<inputType, targetType, CellMap>>;
+  using testCases = std::vector<std::tuple<inputType, targetType, Page>>;
 
   testCases cases{};
   cases.emplace_back("= -5", std::make_unique<ValueObject<int>>(-5), CellMap{});
@@ -79,10 +81,10 @@ TEST_CASE("Prefix Expressions to Objects") {
       CellMap{{CellPos{"ZZ3"},
                DataCell{"= true", std::make_unique<ValueObject<bool>>(true)}}});
 
-  for (const auto& [input, target, cells] : cases) {
+  for (const auto& [input, target, page] : cases) {
     const auto tokens = Lexer::tokenize(input);
     const auto parsed = Parser::parse(tokens);
-    const auto evaluated = Evaluator::evaluate(parsed, cells);
+    const auto evaluated = Evaluator::evaluate(parsed, page);
     CHECK(*evaluated == *target);
   }
 }
@@ -92,7 +94,7 @@ TEST_CASE("Prefix Expressions to Objects") {
 TEST_CASE("Infix Expressions to Objects") {
   using inputType = std::string;
   using targetType = MytObjectPtr;
-  using testCases = std::vector<std::tuple<inputType, targetType, CellMap>>;
+  using testCases = std::vector<std::tuple<inputType, targetType, Page>>;
 
   testCases cases{};
   cases.emplace_back("= 1 + 6", std::make_unique<ValueObject<int>>(7),
@@ -260,27 +262,159 @@ TEST_CASE("Infix Expressions to Objects") {
            DataCell("= 9", std::make_shared<ValueObject<int>>(9))},
       });
 
-  for (const auto& [input, target, cells] : cases) {
+  for (const auto& [input, target, page] : cases) {
     const auto tokens = Lexer::tokenize(input);
     const auto parsed = Parser::parse(tokens);
-    const auto evaluated = Evaluator::evaluate(parsed, cells);
+    const auto evaluated = Evaluator::evaluate(parsed, page);
     CHECK(*evaluated == *target);
   }
 }
 
+TEST_CASE("Comparison Expressions to Objects") {
+  using inputType = std::string;
+  using targetType = MytObjectPtr;
+  using testCases = std::vector<std::tuple<inputType, targetType>>;
+
+  const auto page = Page{CellMap{
+      {CellPos("A1"), DataCell("= 2", std::make_shared<ValueObject<int>>(2))},
+      {CellPos("A2"),
+       DataCell("x", std::make_shared<ValueObject<std::string>>("x"))},
+  }};
+
+  testCases cases = {
+      {"= 1 < 2", std::make_shared<ValueObject<bool>>(true)},
+      {"= 2.5 >= 3", std::make_shared<ValueObject<bool>>(false)},
+      {"= A1 == 2.0", std::make_shared<ValueObject<bool>>(true)},
+      {"= A1 != 2", std::make_shared<ValueObject<bool>>(false)},
+      {"= A1 <= 1 + 1", std::make_shared<ValueObject<bool>>(true)},
+      {"= A2 > \"w\"", std::make_shared<ValueObject<bool>>(true)},
+      {"= A2 == \"x\"", std::make_shared<ValueObject<bool>>(true)},
+      {"= true != false", std::make_shared<ValueObject<bool>>(true)},
+      {"= false < true", std::make_shared<ValueObject<bool>>(true)},
+      {"= C1 == C2", std::make_shared<ValueObject<bool>>(true)},
+      {"= A2 == 2", std::make_shared<ValueObject<bool>>(false)},
+      {"= A2 != 2", std::make_shared<ValueObject<bool>>(true)},
+      {"= A2 < 2", std::make_shared<ErrorObject>("Invalid types for `<`")},
+      {"= 1 / 0 == 1", ZERO_DIV_ERR},
+  };
+
+  for (const auto& [input, target] : cases) {
+    const auto parsed = Parser::parse(Lexer::tokenize(input));
+    const auto evaluated = Evaluator::evaluate(parsed, page);
+    INFO(input);
+    CHECK(*evaluated == *target);
+  }
+}
+
+TEST_CASE("Element-wise Range Expressions to Objects") {
+  using inputType = std::string;
+  using targetType = std::vector<MytValue>;
+  using testCases = std::vector<std::tuple<inputType, targetType>>;
+
+  const auto page = Page{CellMap{
+      {CellPos("A1"), DataCell("= 1", std::make_shared<ValueObject<int>>(1))},
+      {CellPos("A2"), DataCell("= 2", std::make_shared<ValueObject<int>>(2))},
+      {CellPos("A3"),
+       DataCell("= 2.5", std::make_shared<ValueObject<FloatType>>(2.5))},
+      {CellPos("B1"), DataCell("= 0", std::make_shared<ValueObject<int>>(0))},
+      {CellPos("B2"),
+       DataCell("x", std::make_shared<ValueObject<std::string>>("x"))},
+      {CellPos("B3"), DataCell("= 4", std::make_shared<ValueObject<int>>(4))},
+  }};
+  const auto error = [](const std::string& msg) {
+    return MytValue::error(msg);
+  };
+
+  testCases cases = {
+      {"= A1:A3 * 2",
+       {MytValue::from_int(2), MytValue::from_int(4),
+        MytValue::from_float(5.0)}},
+      {"= 7 / A1:A2",
+       {MytValue::from_int(7), MytValue::from_int(3)}},
+      {"= A1:A3 - A1:A3",
+       {MytValue::from_int(0), MytValue::from_int(0),
+        MytValue::from_float(0.0)}},
+      {"= A1:A3 > 1",
+       {MytValue::from_bool(false), MytValue::from_bool(true),
+        MytValue::from_bool(true)}},
+      {"= A1:A3 == B1:B3",
+       {MytValue::from_bool(false), MytValue::from_bool(false),
+        MytValue::from_bool(false)}},
+      {"= A1:A3 / B1:B3",
+       {error("Can't divide by 0"), error("Invalid types for `op`"),
+        MytValue::from_float(0.625)}},
+      {"= A1:A4 + 1",
+       {MytValue::from_int(2), MytValue::from_int(3),
+        MytValue::from_float(3.5), error("Can't add Nil")}},
+      {"= (A1:A3 + 1) * A1:A3",
+       {MytValue::from_int(2), MytValue::from_int(6),
+        MytValue::from_float(8.75)}},
+  };
+
+  for (const auto& [input, target] : cases) {
+    const auto parsed = Parser::parse(Lexer::tokenize(input));
+    const auto evaluated = Evaluator::evaluate(parsed, page);
+    INFO(input);
+    CHECK(*evaluated == ArrayObject{target});
+  }
+
+  const auto mismatched =
+      Evaluator::evaluate(Parser::parse(Lexer::tokenize("= A1:A3 + B1:B2")),
+                          page);
+  CHECK(*mismatched ==
+        ErrorObject{"Element-wise operation on ranges of sizes: 3 and 2"});
+  const auto summed = Evaluator::evaluate(
+      Parser::parse(Lexer::tokenize("= Sum(A1:A2 * 10, 1)")), page);
+  CHECK(*summed == ValueObject<int>{31});
+}
+
+TEST_CASE("Cell range results outlive the page") {
+  using inputType = std::string;
+  using targetType = std::string;
+  using testCases = std::vector<std::tuple<inputType, targetType>>;
+
+  testCases cases = {
+      {"= A1:A3", "A1:A3 ( 1; Nil; 3 )"},
+      {"= If(true, A1:A3, 0)", "A1:A3 ( 1; Nil; 3 )"},
+      {"= Sum(A1:A65000)", "68"},
+      {"= B1:B2", "Error: Invalid expression: nested cell ranges are not "
+                  "supported yet"},
+      {"= B1:B2 + 1", "{ Error: Can't add Nil; Error: Invalid expression: "
+                      "nested cell ranges are not supported yet }"},
+  };
+
+  for (const auto& [input, target] : cases) {
+    auto page = std::make_unique<Page>(CellMap{
+        {CellPos("A1"), DataCell("= 1", std::make_shared<ValueObject<int>>(1))},
+        {CellPos("A3"), DataCell("= 3", std::make_shared<ValueObject<int>>(3))},
+        {CellPos("A65000"),
+         DataCell("= 64", std::make_shared<ValueObject<int>>(64))},
+        {CellPos("B2"),
+         DataCell("= A1:A3",
+                  std::make_shared<CellRangeObject>(
+                      "A1:A3", std::vector<MytValue>{MytValue::from_int(1)}))},
+    });
+    const auto parsed = Parser::parse(Lexer::tokenize(input));
+    const auto evaluated = Evaluator::evaluate(parsed, *page);
+    page.reset();
+    INFO(input);
+    CHECK(evaluated->to_string() == target);
+  }
+}
+
 TEST_CASE("No Arg Call Expressions to Objects") {
   using inputType = std::string;
   using targetType = MytObjectPtr;
-  using testCases = std::vector<std::tuple<inputType, targetType, CellMap>>;
+  using testCases = std::vector<std::tuple<inputType, targetType, Page>>;
 
   testCases cases{};
   cases.emplace_back(
       "= Pi()", std::make_unique<ValueObject<FloatType>>(3.141593), CellMap{});
 
-  for (const auto& [input, target, cells] : cases) {
+  for (const auto& [input, target, page] : cases) {
     const auto tokens = Lexer::tokenize(input);
     const auto parsed = Parser::parse(tokens);
-    const auto evaluated = Evaluator::evaluate(parsed, cells);
+    const auto evaluated = Evaluator::evaluate(parsed, page);
     CHECK(*evaluated == *target);
   }
 }
@@ -288,7 +422,7 @@ TEST_CASE("No Arg Call Expressions to Objects") {
 TEST_CASE("Single Arg Call Expressions to Objects") {
   using inputType = std::string;
   using targetType = MytObjectPtr;
-  using testCases = std::vector<std::tuple<inputType, targetType, CellMap>>;
+  using testCases = std::vector<std::tuple<inputType, targetType, Page>>;
 
   testCases cases{};
   cases.emplace_back("= Sqrt(9)", std::make_unique<ValueObject<FloatType>>(3.0),
@@ -313,10 +447,10 @@ TEST_CASE("Single Arg Call Expressions to Objects") {
            DataCell("= 33", std::make_unique<ValueObject<int>>(33))},
       });
 
-  for (const auto& [input, target, cells] : cases) {
+  for (const auto& [input, target, page] : cases) {
     const auto tokens = Lexer::tokenize(input);
     const auto parsed = Parser::parse(tokens);
-    const auto evaluated = Evaluator::evaluate(parsed, cells);
+    const auto evaluated = Evaluator::evaluate(parsed, page);
     CHECK(*evaluated == *target);
   }
 }
@@ -324,7 +458,7 @@ TEST_CASE("Single Arg Call Expressions to Objects") {
 TEST_CASE("Multi Arg Call Expressions to Objects") {
   using inputType = std::string;
   using targetType = MytObjectPtr;
-  using testCases = std::vector<std::tuple<inputType, targetType, CellMap>>;
+  using testCases = std::vector<std::tuple<inputType, targetType, Page>>;
 
   testCases cases{};
   cases.emplace_back("= Sum(3)", std::make_unique<ValueObject<int>>(3),
@@ -445,10 +579,10 @@ TEST_CASE("Multi Arg Call Expressions to Objects") {
            DataCell("= 13", std::make_unique<ValueObject<int>>(13))},
       });
 
-  for (const auto& [input, target, cells] : cases) {
+  for (const auto& [input, target, page] : cases) {
     const auto tokens = Lexer::tokenize(input);
     const auto parsed = Parser::parse(tokens);
-    const auto evaluated = Evaluator::evaluate(parsed, cells);
+    const auto evaluated = Evaluator::evaluate(parsed, page);
     CHECK(*evaluated == *target);
   }
 }
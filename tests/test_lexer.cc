@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -97,7 +98,43 @@ TEST_CASE("Tokenization") {
                       },
                   }};
 
+  std::vector<TokenView> views{};
   for (const auto& [input, target] : cases) {
     CHECK(Lexer::tokenize(input) == target);
+
+    // Views carry the same tokens and reuse the buffer between calls
+    Lexer::tokenize_views(input, views);
+    std::vector<Token> view_tokens{};
+    for (const auto& view : views) {
+      view_tokens.push_back(view.to_token());
+    }
+    CHECK(view_tokens == target);
+  }
+}
+
+TEST_CASE("Tokenization views point into the source") {
+  using testCases = std::vector<std::tuple<std::string, std::size_t>>;
+  testCases cases{
+      {"= Sum(A1:B20, 2.5) + \"text\" >= true", 14},
+      {"\"unterminated", 2},
+      {"\"\" Ab", 2},
+      {"$ 1", 3},
+  };
+
+  for (const auto& [input, n_tokens] : cases) {
+    const auto views = Lexer::tokenize_views(input);
+    CHECK(views.size() == n_tokens);
+    const auto source_begin = input.data();
+    const auto source_end = input.data() + input.size();
+    for (const auto& view : views) {
+      if (view.type == TokenType::EndOfCell ||
+          view.type == TokenType::Illegal) {
+        continue;
+      }
+      const auto in_source = view.literal.data() >= source_begin &&
+                             view.literal.data() + view.literal.size() <=
+                                 source_end;
+      CHECK(in_source);
+    }
   }
 }
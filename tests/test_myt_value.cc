@@ -0,0 +1,222 @@
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../extern/include/catch.hpp"
+#include "backend/data_cell.hpp"
+#include "backend/myt_lang/element_wise.hpp"
+#include "backend/myt_lang/myt_object.hpp"
+#include "backend/myt_lang/myt_value.hpp"
+
+TEST_CASE("MytValue unboxes scalar objects") {
+  using inputType = MytObjectPtr;
+  using targetType = MytValue::Tag;
+  using testCases = std::vector<std::tuple<inputType, targetType>>;
+
+  testCases cases = {
+      {std::make_shared<ValueObject<int>>(5), MytValue::Tag::Int},
+      {std::make_shared<ValueObject<FloatType>>(6.9f), MytValue::Tag::Float},
+      {std::make_shared<ValueObject<bool>>(true), MytValue::Tag::Bool},
+      {std::make_shared<NilObject>(), MytValue::Tag::Nil},
+      {std::make_shared<ValueObject<std::string>>("lmao"),
+       MytValue::Tag::Object},
+      {std::make_shared<ErrorObject>("err"), MytValue::Tag::Object},
+  };
+
+  for (const auto& [input, target] : cases) {
+    const auto value = MytValue::from_object(input);
+    CHECK(value.tag() == target);
+    CHECK(value.to_string() == input->to_string());
+    CHECK(*value.to_object() == *input);
+  }
+}
+
+TEST_CASE("MytValue operators match MytObject operators") {
+  using operandType = MytObjectPtr;
+  using testCases = std::vector<std::tuple<operandType, operandType>>;
+
+  testCases cases = {
+      {std::make_shared<ValueObject<int>>(7),
+       std::make_shared<ValueObject<int>>(2)},
+      {std::make_shared<ValueObject<int>>(std::numeric_limits<int>::max()),
+       std::make_shared<ValueObject<int>>(2)},
+      {std::make_shared<ValueObject<int>>(std::numeric_limits<int>::min()),
+       std::make_shared<ValueObject<int>>(-1)},
+      {std::make_shared<ValueObject<int>>(7),
+       std::make_shared<ValueObject<FloatType>>(2.5f)},
+      {std::make_shared<ValueObject<FloatType>>(1.5f),
+       std::make_shared<ValueObject<int>>(3)},
+      {std::make_shared<ValueObject<std::string>>("a"),
+       std::make_shared<ValueObject<std::string>>("b")},
+      {std::make_shared<ValueObject<bool>>(true),
+       std::make_shared<ValueObject<int>>(1)},
+      {std::make_shared<NilObject>(), std::make_shared<ValueObject<int>>(1)},
+      {std::make_shared<ErrorObject>("e"),
+       std::make_shared<ValueObject<int>>(1)},
+  };
+
+  for (const auto& [lhs, rhs] : cases) {
+    const auto lhs_value = MytValue::from_object(lhs);
+    const auto rhs_value = MytValue::from_object(rhs);
+    CHECK(MytValue::add(lhs_value, rhs_value).to_string() ==
+          lhs->add(rhs)->to_string());
+    CHECK(MytValue::sub(lhs_value, rhs_value).to_string() ==
+          lhs->sub(rhs)->to_string());
+    CHECK(MytValue::mul(lhs_value, rhs_value).to_string() ==
+          lhs->mul(rhs)->to_string());
+    CHECK(MytValue::div(lhs_value, rhs_value).to_string() ==
+          lhs->div(rhs)->to_string());
+  }
+}
+
+TEST_CASE("Element-wise lanes match scalar operators") {
+  using testCases = std::vector<BinaryOp>;
+
+  const auto values = std::vector<MytValue>{
+      MytValue::from_int(7),
+      MytValue::from_int(-3),
+      MytValue::from_int(0),
+      MytValue::from_int(46340),
+      MytValue::from_float(2.5f),
+      MytValue::from_float(-0.0f),
+      MytValue::from_bool(true),
+      MytValue{},
+      MytValue::from_object(std::make_shared<ValueObject<std::string>>("a")),
+      MytValue::error("e"),
+      MytValue::from_int(std::numeric_limits<int>::max()),
+      MytValue::from_int(std::numeric_limits<int>::min()),
+  };
+  // Every pair of values, once as a range and once as a broadcast scalar
+  std::vector<MytValue> lhs_lanes{};
+  std::vector<MytValue> rhs_lanes{};
+  for (const auto& lhs : values) {
+    for (const auto& rhs : values) {
+      lhs_lanes.push_back(lhs);
+      rhs_lanes.push_back(rhs);
+    }
+  }
+  const auto lhs_range = MytValue::from_object(
+      std::make_shared<CellRangeObject>("A1:A144", lhs_lanes));
+  const auto rhs_range = MytValue::from_object(
+      std::make_shared<CellRangeObject>("B1:B144", rhs_lanes));
+
+  testCases cases = {
+      BinaryOp::Add, BinaryOp::Sub,   BinaryOp::Mul, BinaryOp::Div,
+      BinaryOp::Eq,  BinaryOp::NotEq, BinaryOp::Gt,  BinaryOp::Ge,
+      BinaryOp::Lt,  BinaryOp::Le,
+  };
+
+  for (const auto& op : cases) {
+    const auto scalar = [&](const MytValue& lhs, const MytValue& rhs) {
+      if (op == BinaryOp::Div && rhs.is_numeric() && rhs.get_number() == 0) {
+        return MytValue::error("Can't divide by 0");
+      }
+      return MytValue::binary(op, lhs, rhs);
+    };
+    const auto ranges = MytValue::binary(op, lhs_range, rhs_range);
+    const auto broadcast = MytValue::binary(op, lhs_range, values[4]);
+    const auto ranges_array = D_CAST(ArrayObject, ranges.get_object());
+    const auto broadcast_array = D_CAST(ArrayObject, broadcast.get_object());
+    REQUIRE(ranges_array != nullptr);
+    REQUIRE(broadcast_array != nullptr);
+
+    auto mismatches = std::size_t{0};
+    for (std::size_t i{0}; i < lhs_lanes.size(); ++i) {
+      const auto expected = scalar(lhs_lanes[i], rhs_lanes[i]);
+      const auto got = ranges_array->get(i);
+      mismatches += got.tag() != expected.tag() ||
+                    got.to_string() != expected.to_string();
+      const auto expected_broadcast = scalar(lhs_lanes[i], values[4]);
+      mismatches +=
+          broadcast_array->get(i).to_string() != expected_broadcast.to_string();
+    }
+    INFO(static_cast<int>(op));
+    CHECK(mismatches == 0);
+  }
+
+  // Int lanes leaving the `int` range become floats instead of overflowing
+  const auto overflow = MytValue::mul(lhs_range, MytValue::from_int(50000));
+  const auto overflow_array = D_CAST(ArrayObject, overflow.get_object());
+  REQUIRE(overflow_array != nullptr);
+  CHECK(overflow_array->get(36).tag() == MytValue::Tag::Float);
+  CHECK(overflow_array->get(36).get_float() == 46340.0f * 50000.0f);
+  // The same for single values
+  const auto int_max = MytValue::from_int(std::numeric_limits<int>::max());
+  const auto scalar_overflow = MytValue::add(int_max, MytValue::from_int(1));
+  CHECK(scalar_overflow.tag() == MytValue::Tag::Float);
+  CHECK(scalar_overflow.to_string() ==
+        D_CAST(ArrayObject,
+               MytValue::add(lhs_range, MytValue::from_int(1)).get_object())
+            ->get(120)
+            .to_string());
+}
+
+TEST_CASE("MytValue copies share boxed objects") {
+  const auto obj = std::make_shared<ValueObject<std::string>>("shared");
+  auto value = MytValue::from_object(obj);
+  {
+    const auto copy = value;
+    auto moved = MytValue{copy};
+    CHECK(moved.get_object() == obj.get());
+    value = std::move(moved);
+    CHECK(moved.is_nil());
+  }
+  CHECK(value.get_object() == obj.get());
+  CHECK(obj.use_count() == 2);
+
+  value = MytValue::from_int(1);
+  CHECK(obj.use_count() == 1);
+
+  const auto data_cell = DataCell{"= 1", std::make_shared<ValueObject<int>>(1)};
+  CHECK(data_cell.get_value().tag() == MytValue::Tag::Int);
+  CHECK(data_cell.to_string() == "1");
+}
+
+TEST_CASE("MytValue equality is typed") {
+  using testCases = std::vector<std::tuple<MytValue, MytValue, bool>>;
+
+  const auto str = [](const std::string& value) {
+    return MytValue::from_object(
+        std::make_shared<ValueObject<std::string>>(value));
+  };
+  const auto range = [](const std::vector<MytValue>& values) {
+    return MytValue::from_object(
+        std::make_shared<CellRangeObject>("A1:A2", values));
+  };
+  const auto shared = str("same box");
+
+  testCases cases = {
+      {MytValue{}, MytValue{}, true},
+      {MytValue::from_int(5), MytValue::from_int(5), true},
+      {MytValue::from_int(5), MytValue::from_int(6), false},
+      {MytValue::from_int(5), MytValue::from_float(5.0f), false},
+      {MytValue::from_float(0.0f), MytValue::from_float(-0.0f), false},
+      {MytValue::from_float(1.5f), MytValue::from_float(1.5f), true},
+      {MytValue::from_bool(true), MytValue::from_int(1), false},
+      {MytValue{}, MytValue::from_object(std::make_shared<NilObject>()), true},
+      {shared, shared, true},
+      {str("a"), str("a"), true},
+      {str("a"), str("b"), false},
+      {str("a"), MytValue::from_object(std::make_shared<IdentObject>("\"a\"")),
+       false},
+      {MytValue::error("e"), MytValue::error("e"), true},
+      {MytValue::error("e"), str("Error: e"), false},
+      {range({MytValue::from_int(1), MytValue{}}),
+       range({MytValue::from_int(1), MytValue{}}), true},
+      {range({MytValue::from_int(1), MytValue{}}),
+       range({MytValue::from_float(1.0f), MytValue{}}), false},
+      {MytValue::mul(range({MytValue::from_int(1), str("x")}),
+                     MytValue::from_int(2)),
+       MytValue::mul(range({MytValue::from_int(1), str("x")}),
+                     MytValue::from_int(2)),
+       true},
+  };
+
+  for (const auto& [lhs, rhs, target] : cases) {
+    INFO(lhs.to_string() + " == " + rhs.to_string());
+    CHECK((lhs == rhs) == target);
+    CHECK((rhs == lhs) == target);
+  }
+}
@@ -0,0 +1,192 @@
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../extern/include/catch.hpp"
+#include "backend/cell_block.hpp"
+#include "backend/data_cell.hpp"
+#include "backend/myt_lang/cell_pos.hpp"
+#include "backend/myt_lang/formula.hpp"
+#include "backend/myt_lang/myt_object.hpp"
+#include "backend/page.hpp"
+
+TEST_CASE("Page saving and erasing cells") {
+  using cellInputs = std::vector<std::tuple<CellPos, std::string>>;
+  using erasedCells = std::vector<CellPos>;
+  using targets = std::vector<std::tuple<CellPos, std::optional<std::string>>>;
+  using testCases = std::vector<std::tuple<cellInputs, erasedCells, targets>>;
+
+  testCases cases = {
+      {
+          cellInputs{{CellPos{"A1"}, "a"}, {CellPos{"A1"}, "b"}},
+          erasedCells{},
+          targets{{CellPos{"A1"}, "b"}, {CellPos{"A2"}, std::nullopt}},
+      },
+      {
+          cellInputs{
+              {CellPos{"B255"}, "x"},
+              {CellPos{"B256"}, "y"},
+              {CellPos{"B257"}, "z"},
+              {CellPos{"C1000"}, "w"},
+          },
+          erasedCells{CellPos{"B256"}, CellPos{"C1000"}, CellPos{"D1"}},
+          targets{
+              {CellPos{"B255"}, "x"},
+              {CellPos{"B256"}, std::nullopt},
+              {CellPos{"B257"}, "z"},
+              {CellPos{"C1000"}, std::nullopt},
+          },
+      },
+      {
+          cellInputs{
+              {CellPos{"A1"}, "1"},
+              {CellPos{"A2"}, "2"},
+              {CellPos{"A3"}, "3"},
+          },
+          erasedCells{CellPos{"A1"}},
+          targets{
+              {CellPos{"A1"}, std::nullopt},
+              {CellPos{"A2"}, "2"},
+              {CellPos{"A3"}, "3"},
+          },
+      },
+  };
+
+  for (const auto& [inputs, erased, expected] : cases) {
+    Page page{};
+    for (const auto& [pos, raw] : inputs) {
+      page.save_cell(DataCell{raw, std::make_shared<NilObject>()}, pos);
+    }
+    for (const auto& pos : erased) {
+      page.erase_cell(pos);
+    }
+    for (const auto& [pos, target] : expected) {
+      CHECK(page.get_cell_raw_content(pos) == target);
+      CHECK(page.cell_exists(pos) == target.has_value());
+    }
+  }
+}
+
+TEST_CASE("Page copies don't share writes") {
+  Page page{};
+  page.save_cell(DataCell{"= 1", std::make_shared<ValueObject<int>>(1)},
+                 CellPos{"A1"});
+  auto copy = page;
+  copy.save_cell(DataCell{"= 2", std::make_shared<ValueObject<int>>(2)},
+                 CellPos{"A1"});
+  copy.erase_cell(CellPos{"A1"});
+  copy.save_cell(DataCell{"= 3", std::make_shared<ValueObject<int>>(3)},
+                 CellPos{"A2"});
+
+  CHECK(page.get_cell_eval_content(CellPos{"A1"}) == "1");
+  CHECK(!page.cell_exists(CellPos{"A2"}));
+  CHECK(!copy.cell_exists(CellPos{"A1"}));
+  CHECK(copy.get_cell_eval_content(CellPos{"A2"}) == "3");
+  CHECK(page.size() == 1);
+  CHECK(copy.size() == 1);
+}
+
+TEST_CASE("Page range visits and numeric blocks") {
+  Page page{};
+  page.save_cell(DataCell{"= 4", std::make_shared<ValueObject<int>>(4)},
+                 CellPos{"B2"});
+  page.save_cell(
+      DataCell{"= 2.5", std::make_shared<ValueObject<FloatType>>(2.5)},
+      CellPos{"B3"});
+  page.save_cell(DataCell{"a", std::make_shared<ValueObject<std::string>>("a")},
+                 CellPos{"C2"});
+
+  std::vector<std::string> visited{};
+  page.visit_range(CellPos{"B2"}, CellPos{"C3"},
+                   [&visited](const CellPos& pos, const DataCell* data_cell) {
+                     visited.emplace_back(pos.to_string() + ":" +
+                                          (data_cell ? data_cell->to_string()
+                                                     : std::string{"-"}));
+                   });
+  CHECK(visited == std::vector<std::string>{"B2:4", "B3:2.500000",
+                                            "C2:\"a\"", "C3:-"});
+
+  const auto block = page.get_block(2, 0);
+  REQUIRE(block != nullptr);
+  CHECK(block->size() == 2);
+  CHECK(block->numeric().test(2));
+  CHECK(!block->floats().test(2));
+  CHECK(block->floats().test(3));
+  CHECK(block->numbers()[2] == 4.0);
+  CHECK(block->numbers()[3] == 2.5);
+  CHECK(!page.get_block(3, 0)->numeric().test(2));
+}
+
+TEST_CASE("Page occupied visits skip empty cells and blocks") {
+  using testCases =
+      std::vector<std::tuple<CellPos, CellPos, std::vector<std::string>>>;
+
+  Page page{};
+  for (const auto& pos : {"A1", "A256", "A257", "A65000", "B300", "D2"}) {
+    page.save_cell(DataCell{"= 1", std::make_shared<ValueObject<int>>(1)},
+                   CellPos{pos});
+  }
+
+  testCases cases = {
+      {CellPos{"A1"}, CellPos{"A65000"}, {"A1", "A256", "A257", "A65000"}},
+      {CellPos{"A2"}, CellPos{"A64999"}, {"A256", "A257"}},
+      {CellPos{"A257"}, CellPos{"A257"}, {"A257"}},
+      {CellPos{"A1"}, CellPos{"D400"}, {"A1", "A256", "A257", "B300", "D2"}},
+      {CellPos{"C1"}, CellPos{"C65000"}, {}},
+      {CellPos{"A300"}, CellPos{"B1"}, {}},
+  };
+
+  for (const auto& [begin, end, target] : cases) {
+    std::vector<std::string> visited{};
+    page.visit_occupied(begin, end,
+                        [&visited](const CellPos& pos, const DataCell&) {
+                          visited.push_back(pos.to_string());
+                        });
+    INFO(begin.to_string() + ":" + end.to_string());
+    CHECK(visited == target);
+  }
+}
+
+TEST_CASE("Cell range views read the page lazily") {
+  Page page{};
+  page.save_cell(DataCell{"= 2", std::make_shared<ValueObject<int>>(2)},
+                 CellPos{"A2"});
+  page.save_cell(
+      DataCell{"= 1.5", std::make_shared<ValueObject<FloatType>>(1.5)},
+      CellPos{"B1"});
+
+  const auto view =
+      CellRangeObject{"A1:B2", page, CellPos{"A1"}, CellPos{"B2"}};
+  CHECK(view.is_view());
+  CHECK(view.size() == 4);
+  std::vector<std::size_t> occupied{};
+  view.for_each_occupied([&occupied](const std::size_t& idx, const MytValue&) {
+    occupied.push_back(idx);
+  });
+  CHECK(occupied == std::vector<std::size_t>{1, 2});
+
+  const auto detached = CellRangeObject::detach(
+      MytValue::from_object(std::make_shared<CellRangeObject>(
+          "A1:B2", page, CellPos{"A1"}, CellPos{"B2"})));
+  page.erase_cell(CellPos{"A2"});
+  const auto detached_range =
+      dynamic_cast<const CellRangeObject*>(detached.get_object());
+  REQUIRE(detached_range != nullptr);
+  CHECK(!detached_range->is_view());
+  CHECK(detached_range->to_string() == "A1:B2 ( Nil; 2; 1.500000; Nil )");
+  CHECK(view.to_string() == "A1:B2 ( Nil; Nil; 1.500000; Nil )");
+}
+
+TEST_CASE("DataCell keeps compiled formula until raw content edit") {
+  const auto formula = Formula::compile("= A1 + 1");
+  auto data_cell =
+      DataCell{"= A1 + 1", std::make_shared<NilObject>(), formula};
+  CHECK(data_cell.get_formula() == formula);
+
+  data_cell.set_raw_content("= A1 + 1");
+  CHECK(data_cell.get_formula() == formula);
+
+  data_cell.set_raw_content("= A1 + 2");
+  CHECK(data_cell.get_formula() == nullptr);
+}
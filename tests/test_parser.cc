@@ -183,12 +183,12 @@ TEST_CASE("Parsing call expressions") {
   using testCases = std::vector<std::tuple<inputType, targetType>>;
 
   testCases cases{
-      {"= foo()", "fn_call(ident(foo)())"},
-      {"= bar(B23)", "fn_call(ident(bar)(cell(B23)))"},
-      {"= add(5, 3)", "fn_call(ident(add)(int(5), int(3)))"},
-      {"= add(5, sub(3, 2), 8)",
-       "fn_call(ident(add)(int(5), fn_call(ident(sub)(int(3), int(2))), "
-       "int(8)))"},
+      {"= Pi()", "fn_call(ident(Pi)())"},
+      {"= Sqrt(B23)", "fn_call(ident(Sqrt)(cell(B23)))"},
+      {"= Sum(5, 3)", "fn_call(ident(Sum)(int(5), int(3)))"},
+      {"= Sum(5, Sqrt(3), 8)",
+       "fn_call(ident(Sum)(int(5), fn_call(ident(Sqrt)(int(3))), int(8)))"},
+      {"= A1(2)", "fn_call(cell(A1)(int(2)))"},
   };
   for (const auto& [input, target] : cases) {
     const auto tokens = Lexer::tokenize(input);
@@ -238,3 +238,127 @@ TEST_CASE("Parsing float expressions") {
     CHECK(*expr->get() == *target);
   }
 }
+
+TEST_CASE("Parsing invalid inputs") {
+  using testCases = std::vector<std::tuple<std::string, std::string>>;
+
+  testCases cases{
+      {"= 5 +", "Prefix expression for: `EOC` not implemented"},
+      {"= (1", "expected: `)`, got: `EOC`"},
+      {"= Sum(1,", "Prefix expression for: `EOC` not implemented"},
+      {"= 5 5", "Couldn't parse: `5`"},
+      {"= A70000", "Invalid range in: `A70000` max: `65534`"},
+      {"= ZZZZ1 + 1", "Invalid range in: `ZZZZ1` max: `65534`"},
+      {"= Sum(A1:A99999999999999999999)",
+       "Invalid range in: `A99999999999999999999` max: `65534`"},
+      {"= A65535", "Invalid range in: `A65535` max: `65534`"},
+      {"= CRXO1", "Invalid range in: `CRXO1` max: `65534`"},
+      {"= foo()", "No function named: `foo`"},
+      {"= Sum(1, sum(2))", "No function named: `sum`"},
+      {"= Pi(1)", "Function: `Pi` takes: 0 arguments, got: 1"},
+      {"= Sqrt(1, 2)", "Function: `Sqrt` takes: 1 arguments, got: 2"},
+      {"= 1 + Sum()", "Function: `Sum` takes: More than 0 arguments, got: 0"},
+  };
+
+  for (const auto& [input, target] : cases) {
+    const auto parsed = Parser::parse(Lexer::tokenize(input));
+    REQUIRE(std::holds_alternative<ParsingError>(parsed));
+    CHECK(std::get<ParsingError>(parsed).content == target);
+  }
+}
+
+TEST_CASE("Parsing expression kinds") {
+  using testCases = std::vector<std::tuple<std::string, ExpressionKind>>;
+
+  testCases cases{
+      {"= 8", ExpressionKind::IntLiteral},
+      {"= 8.5", ExpressionKind::FloatLiteral},
+      {"= true", ExpressionKind::BoolLiteral},
+      {"= \"text\"", ExpressionKind::StringLiteral},
+      {"text", ExpressionKind::StringLiteral},
+      {"= Sum", ExpressionKind::Identifier},
+      {"= A1", ExpressionKind::Cell},
+      {"= CRXN65534", ExpressionKind::Cell},
+      {"= -A1", ExpressionKind::Prefix},
+      {"= A1 + 2", ExpressionKind::Infix},
+      {"= A1:B2", ExpressionKind::CellRange},
+      {"= Sum(A1:B2)", ExpressionKind::FnCall},
+  };
+
+  for (const auto& [input, target] : cases) {
+    const auto parsed = Parser::parse(Lexer::tokenize(input));
+    REQUIRE(std::holds_alternative<ExpressionSharedPtr>(parsed));
+    const auto& expr = *std::get<ExpressionSharedPtr>(parsed);
+    CHECK(expr.kind() == target);
+    // `visit` hands out the node under its concrete type
+    const auto visited_kind = AstUtils::visit(
+        expr,
+        AstUtils::Overloaded{
+            [](const ExpressionLiteral<int>&) {
+              return ExpressionKind::IntLiteral;
+            },
+            [](const ExpressionLiteral<FloatType>&) {
+              return ExpressionKind::FloatLiteral;
+            },
+            [](const ExpressionLiteral<bool>&) {
+              return ExpressionKind::BoolLiteral;
+            },
+            [](const ExpressionLiteral<std::string>&) {
+              return ExpressionKind::StringLiteral;
+            },
+            [](const ExpressionIdentifier&) {
+              return ExpressionKind::Identifier;
+            },
+            [](const ExpressionCell&) { return ExpressionKind::Cell; },
+            [](const ExpressionPrefix&) { return ExpressionKind::Prefix; },
+            [](const ExpressionInfix&) { return ExpressionKind::Infix; },
+            [](const ExpressionCellRange&) {
+              return ExpressionKind::CellRange;
+            },
+            [](const ExpressionFnCall&) { return ExpressionKind::FnCall; },
+        });
+    CHECK(visited_kind == target);
+  }
+}
+
+TEST_CASE("Parsing resolves builtin calls") {
+  using testCases = std::vector<std::tuple<std::string, BuiltinId>>;
+
+  testCases cases{
+      {"= Pi()", BuiltinId::Pi},
+      {"= Sqrt(A1 * 2)", BuiltinId::Sqrt},
+      {"= Sum(A1:B2, 1, 2)", BuiltinId::Sum},
+  };
+
+  for (const auto& [input, builtin] : cases) {
+    const auto parsed = Parser::parse(Lexer::tokenize(input));
+    REQUIRE(std::holds_alternative<ExpressionSharedPtr>(parsed));
+    const auto& expr = *std::get<ExpressionSharedPtr>(parsed);
+    REQUIRE(expr.kind() == ExpressionKind::FnCall);
+    CHECK(static_cast<const ExpressionFnCall&>(expr).get_builtin() == builtin);
+  }
+}
+
+TEST_CASE("Parsing resolved cell positions") {
+  using testCases = std::vector<
+      std::tuple<std::string, CellPos, std::tuple<CellPos, CellPos>>>;
+
+  testCases cases{
+      {"= A1:B2", CellPos{1, 1}, {CellPos{1, 1}, CellPos{2, 2}}},
+      {"= B2:A1", CellPos{2, 2}, {CellPos{1, 1}, CellPos{2, 2}}},
+      {"= AA10:C3", CellPos{27, 10}, {CellPos{3, 3}, CellPos{27, 10}}},
+  };
+
+  for (const auto& [input, lhs_pos, bounds] : cases) {
+    const auto parsed = Parser::parse(Lexer::tokenize(input));
+    REQUIRE(std::holds_alternative<ExpressionSharedPtr>(parsed));
+    const auto& expr = *std::get<ExpressionSharedPtr>(parsed);
+    REQUIRE(expr.kind() == ExpressionKind::CellRange);
+
+    const auto& range = static_cast<const ExpressionCellRange&>(expr);
+    const auto& lhs = range.get_lhs_expression();
+    CHECK(static_cast<const ExpressionCell&>(lhs).get_pos() == lhs_pos);
+    REQUIRE(range.get_range_bounds().has_value());
+    CHECK(*range.get_range_bounds() == bounds);
+  }
+}
@@ -0,0 +1,57 @@
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "../extern/include/catch.hpp"
+#include "backend/myt_lang/cell_pos.hpp"
+#include "backend/range_index.hpp"
+
+TEST_CASE("Range index matches brute force stabbing") {
+  using Range = std::tuple<CellPos, CellPos, CellPos>;
+
+  std::mt19937 rng{42};
+  const auto next = [&rng](const uint32_t& bound) {
+    return static_cast<CellLimitType>(rng() % bound);
+  };
+
+  RangeIndex index{};
+  std::vector<Range> ranges{};
+  for (CellLimitType owner_row{0}; owner_row < 400; ++owner_row) {
+    const auto owner = CellPos{500, owner_row};
+    const auto col = next(200);
+    const auto row = next(1000);
+    const auto begin = CellPos{col, row};
+    const auto end = CellPos{static_cast<CellLimitType>(col + next(150)),
+                             static_cast<CellLimitType>(row + next(300))};
+    index.insert(owner, begin, end);
+    ranges.emplace_back(owner, begin, end);
+  }
+  // Drop every third owner
+  std::vector<Range> kept{};
+  for (std::size_t i{0}; i < ranges.size(); ++i) {
+    if (i % 3 == 0) {
+      index.erase_owner(std::get<0>(ranges[i]));
+    } else {
+      kept.push_back(ranges[i]);
+    }
+  }
+  CHECK(index.size() == kept.size());
+
+  for (int probe{0}; probe < 2000; ++probe) {
+    const auto pos = CellPos{next(400), next(1400)};
+    std::unordered_multiset<CellPos> found{};
+    index.for_each_owner_at(
+        pos, [&found](const CellPos& owner) { found.insert(owner); });
+
+    std::unordered_multiset<CellPos> expected{};
+    for (const auto& [owner, begin, end] : kept) {
+      if (begin.col <= pos.col && pos.col <= end.col &&
+          begin.row <= pos.row && pos.row <= end.row) {
+        expected.insert(owner);
+      }
+    }
+    CHECK(found == expected);
+  }
+}
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include "../extern/include/catch.hpp"
+#include "backend/thread_pool.hpp"
+
+TEST_CASE("Thread pool parallel for") {
+  using testCases = std::vector<std::tuple<std::size_t, std::size_t>>;
+
+  testCases cases = {
+      {1, 0}, {1, 1}, {2, 7}, {4, 3}, {4, 64}, {8, 1000}, {3, 100003},
+  };
+
+  for (const auto& [n_workers, n] : cases) {
+    ThreadPool pool{n_workers};
+    CHECK(pool.size() == n_workers);
+
+    // Every index has to be visited exactly once, over several rounds so
+    // sleeping workers get woken up again
+    std::vector<std::atomic<int>> visits(n);
+    for (int round{1}; round <= 3; ++round) {
+      pool.parallel_for(n, [&visits](const std::size_t& begin,
+                                     const std::size_t& end) {
+        for (auto i = begin; i < end; ++i) {
+          visits[i].fetch_add(1);
+        }
+      });
+      const auto all_visited = std::all_of(
+          visits.cbegin(), visits.cend(),
+          [&round](const std::atomic<int>& visit) { return visit == round; });
+      CHECK(all_visited);
+    }
+  }
+}
@@ -0,0 +1,256 @@
+#include <memory>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <vector>
+
+#include "../extern/include/catch.hpp"
+#include "backend/data_cell.hpp"
+#include "backend/myt_lang/evaluator.hpp"
+#include "backend/myt_lang/formula.hpp"
+#include "backend/myt_lang/myt_object.hpp"
+#include "backend/myt_lang/myt_value.hpp"
+#include "backend/myt_lang/vm.hpp"
+#include "backend/page.hpp"
+
+TEST_CASE("Vm matches tree walking evaluator") {
+  using inputType = std::string;
+  using testCases = std::vector<std::tuple<inputType, bool>>;
+
+  const auto page = Page{CellMap{
+      {CellPos{"A1"}, DataCell{"= 2", std::make_shared<ValueObject<int>>(2)}},
+      {CellPos{"A2"},
+       DataCell{"= 1.5", std::make_shared<ValueObject<FloatType>>(1.5)}},
+      {CellPos{"A3"},
+       DataCell{"= true", std::make_shared<ValueObject<bool>>(true)}},
+      {CellPos{"B1"},
+       DataCell{"x", std::make_shared<ValueObject<std::string>>("x")}},
+      {CellPos{"B2"},
+       DataCell{"= 1/0", std::make_shared<ErrorObject>("Division by zero")}},
+  }};
+
+  // Second element: whether the formula is expected to be compiled
+  testCases cases = {
+      {"= 5", true},
+      {"= 6.9", true},
+      {"= \"lmao\"", true},
+      {"= -A1", true},
+      {"= -A2", true},
+      {"= -A3", true},
+      {"= !A3", true},
+      {"= !A1", true},
+      {"= A1 + A2 * 3", true},
+      {"= (A1 - 7) / 2", true},
+      {"= A1 / 4.0", true},
+      {"= A1 / 0", true},
+      {"= A2 / 0.0", true},
+      {"= A1 + B1", true},
+      {"= B1 + B1", true},
+      {"= B1 * 3", true},
+      {"= A3 + 1", true},
+      {"= B2 + 1", true},
+      {"= C9 + 1", true},
+      {"= Sum(A1:A3)", true},
+      {"= Sum(A1:B2, 4)", true},
+      {"= Sqrt(A1 * 8)", true},
+      {"= Pi()", true},
+      {"= Unknown(1)", true},
+      {"= A1:A2", true},
+      {"= A1 == 2", true},
+      {"= A1 > A2", true},
+      {"= B1 != \"x\"", true},
+      {"= B1 < 1", true},
+      {"= A1:A3 * 2", true},
+      {"= A1:A2 >= 2", true},
+      {"= A1:B2 + A1:B2", true},
+      {"= 10 / A1:A2", true},
+      {"= Sum(A1:A2 * A1:A2)", true},
+      {"= 5 5", true},
+      {"= A1(2)", false},
+  };
+
+  for (const auto& [input, compiled] : cases) {
+    const auto formula = Formula::compile(input);
+    CHECK(formula->get_program().has_value() == compiled);
+
+    const auto walked = Evaluator::evaluate(formula->get_parsed(), page);
+    const auto executed = formula->evaluate(page).to_object();
+    INFO(input);
+    CHECK(*walked == *executed);
+    CHECK(typeid(*walked) == typeid(*executed));
+  }
+}
+
+TEST_CASE("Vm keeps numeric results unboxed until the end") {
+  const auto formula = Formula::compile("= A1 + 2 * 3 - 4 / A1");
+  REQUIRE(formula->get_program().has_value());
+
+  const auto& program = *formula->get_program();
+  CHECK(program.max_stack == 3);
+  CHECK(program.constants.size() == 2);
+
+  const auto page = Page{CellMap{
+      {CellPos{"A1"}, DataCell{"= 2", std::make_shared<ValueObject<int>>(2)}},
+  }};
+  const auto result = Vm::execute(program, page);
+  CHECK(result.tag() == MytValue::Tag::Int);
+  CHECK(result.get_int() == 6);
+}
+
+TEST_CASE("Compiler folds constant subtrees") {
+  using testCases = std::vector<std::tuple<std::string, std::size_t>>;
+
+  const auto page = Page{CellMap{
+      {CellPos{"A1"}, DataCell{"= 3", std::make_shared<ValueObject<int>>(3)}},
+      {CellPos{"A2"},
+       DataCell{"= 1.5", std::make_shared<ValueObject<FloatType>>(1.5)}},
+  }};
+
+  // Second element: instructions left after folding
+  testCases cases = {
+      {"= 1 + 2 * 3", 1},
+      {"= (7 + 5) / 2 * Pi()", 1},
+      {"= 7 / 2", 1},
+      {"= 7 / 2.0", 1},
+      {"= 1 / 0", 1},
+      {"= -(2 + 3)", 1},
+      {"= !true", 1},
+      {"= \"a\" + 1", 1},
+      {"= Sum(1, 2.5, 3)", 1},
+      {"= Sqrt(16) + Unknown()", 1},
+      {"= A1 * (60 * 60 * 24)", 3},
+      {"= A1 * 60 * 60", 5},
+      {"= 60 * 60 * A2", 3},
+      {"= Sum(A1:A2, 1 + 1)", 3},
+      {"= -A1 + Pi()", 4},
+      {"= 1 < 2", 1},
+      {"= \"a\" == \"a\"", 1},
+      {"= A1 >= 2 * 2", 3},
+  };
+
+  for (const auto& [input, n_instructions] : cases) {
+    const auto formula = Formula::compile(input);
+    REQUIRE(formula->get_program().has_value());
+    INFO(input);
+    CHECK(formula->get_program()->code.size() == n_instructions);
+
+    const auto walked = Evaluator::evaluate(formula->get_parsed(), page);
+    const auto executed = formula->evaluate(page).to_object();
+    CHECK(*walked == *executed);
+    CHECK(typeid(*walked) == typeid(*executed));
+  }
+}
+
+TEST_CASE("Filled down formulas share one compiled shape") {
+  using testCases =
+      std::vector<std::tuple<std::string, CellPos, std::string, CellPos, bool>>;
+
+  testCases cases = {
+      {"=A2*B2", CellPos{"C2"}, "=A3*B3", CellPos{"C3"}, true},
+      {"=A2*B2", CellPos{"C2"}, "=B2*C2", CellPos{"D2"}, true},
+      {"= A2 * B2", CellPos{"C2"}, "=A3*B3", CellPos{"C3"}, true},
+      {"=A2*B2", CellPos{"C2"}, "=A3*B2", CellPos{"C3"}, false},
+      {"=A2*2", CellPos{"C2"}, "=A3*3", CellPos{"C3"}, false},
+      {"=Sum(A1:B2)", CellPos{"C2"}, "=Sum(A2:B3)", CellPos{"C3"}, true},
+      {"=5 5", CellPos{"C2"}, "=5 5", CellPos{"C3"}, false},
+      // Text cells read as written
+      {"A2", CellPos{"C2"}, "A3", CellPos{"C3"}, false},
+      {"Total B1", CellPos{"C4"}, "Total B2", CellPos{"C5"}, false},
+  };
+
+  const auto page = Page{};
+  for (const auto& [lhs, lhs_pos, rhs, rhs_pos, shared] : cases) {
+    const auto lhs_formula = Formula::compile(lhs, lhs_pos);
+    const auto rhs_formula = Formula::compile(rhs, rhs_pos);
+    INFO(lhs << " " << rhs);
+    CHECK((lhs_formula == rhs_formula) == shared);
+    CHECK(rhs_formula->evaluate(page, rhs_pos).to_string() ==
+          Formula::compile(rhs)->evaluate(page).to_string());
+  }
+}
+
+TEST_CASE("Shared formulas evaluate relative to their cell") {
+  const auto page = Page{CellMap{
+      {CellPos{"A1"}, DataCell{"= 2", std::make_shared<ValueObject<int>>(2)}},
+      {CellPos{"A2"}, DataCell{"= 3", std::make_shared<ValueObject<int>>(3)}},
+      {CellPos{"A3"}, DataCell{"= 4", std::make_shared<ValueObject<int>>(4)}},
+      {CellPos{"B1"}, DataCell{"= 5", std::make_shared<ValueObject<int>>(5)}},
+      {CellPos{"B2"}, DataCell{"= 6", std::make_shared<ValueObject<int>>(6)}},
+      {CellPos{"B3"}, DataCell{"= 7", std::make_shared<ValueObject<int>>(7)}},
+  }};
+
+  using testCases = std::vector<std::tuple<std::string, CellPos>>;
+  testCases cases = {
+      {"=A1*B1", CellPos{"C1"}},      {"=A2*B2", CellPos{"C2"}},
+      {"=A3*B3", CellPos{"C3"}},      {"=Sum(A1:B2)", CellPos{"C2"}},
+      {"=Sum(A2:B3)", CellPos{"C3"}}, {"=A1:A2", CellPos{"C1"}},
+      {"=A2:A3", CellPos{"C2"}},      {"=-A1 + 1", CellPos{"D5"}},
+      {"=-A3 + 1", CellPos{"D7"}},
+  };
+
+  for (const auto& [input, pos] : cases) {
+    const auto shared = Formula::compile(input, pos);
+    const auto unshared = Formula::compile(input);
+    INFO(input);
+    CHECK(*shared->evaluate(page, pos).to_object() ==
+          *unshared->evaluate(page).to_object());
+    CHECK(shared->evaluate(page, pos).to_string() ==
+          unshared->evaluate(page).to_string());
+  }
+}
+
+TEST_CASE("Lazy builtins only evaluate the arguments they need") {
+  using testCases = std::vector<std::tuple<std::string, std::string>>;
+
+  const auto page = Page{CellMap{
+      {CellPos{"A1"}, DataCell{"= 2", std::make_shared<ValueObject<int>>(2)}},
+      {CellPos{"A2"}, DataCell{"= 0", std::make_shared<ValueObject<int>>(0)}},
+      {CellPos{"A3"},
+       DataCell{"= true", std::make_shared<ValueObject<bool>>(true)}},
+      {CellPos{"B1"},
+       DataCell{"x", std::make_shared<ValueObject<std::string>>("x")}},
+      {CellPos{"B2"},
+       DataCell{"= 1/0", std::make_shared<ErrorObject>("Division by zero")}},
+  }};
+
+  testCases cases = {
+      {"= If(A3, 1, 2)", "1"},
+      {"= If(A2, 1, 2)", "2"},
+      {"= If(A1, 1)", "1"},
+      {"= If(A2, 1)", "false"},
+      {"= If(C9, 1, 2)", "2"},
+      {"= If(B2, 1, 2)", "Error: Division by zero"},
+      {"= If(B1, 1, 2)",
+       "Error: Wrong type in function: `If` wants: `bool` got: `\"x\"`"},
+      {"= If(true, 1, 1 / 0)", "1"},
+      {"= If(false, 1 / 0, Sum(A1:A2) + 1)", "3"},
+      {"= And(A3, A1, true)", "true"},
+      {"= And(A3, A2, B2)", "false"},
+      {"= And(B2, false)", "Error: Division by zero"},
+      {"= Or(A2, A1, B2)", "true"},
+      {"= Or(false, A2)", "false"},
+      {"= IfError(B2, 5)", "5"},
+      {"= IfError(A1, 5)", "2"},
+      {"= IfError(1 / 0, Sum(A1:A2))", "2"},
+      {"= Choose(2, 10, 20, 30)", "20"},
+      {"= Choose(A1 + 0.5, 10, 20, 30)", "20"},
+      {"= Choose(4, 10, 20, 30)",
+       "Error: Choose index: 4 out of range: [1, 3]"},
+      {"= Choose(B2, 10, 20)", "Error: Division by zero"},
+      {"= If(A3, If(A2, 1, 2), 3) + 1", "3"},
+      {"= If(A3, 1 + 2, 3) * 2", "6"},
+      {"= Sum(If(A3, A1, A2), Choose(1, 5), Or(A2, A2))", "7"},
+  };
+
+  for (const auto& [input, target] : cases) {
+    const auto formula = Formula::compile(input);
+    INFO(input);
+    REQUIRE(formula->get_program().has_value());
+
+    const auto walked = Evaluator::evaluate(formula->get_parsed(), page);
+    const auto executed = formula->evaluate(page);
+    CHECK(walked->to_string() == target);
+    CHECK(executed.to_string() == target);
+    CHECK(*walked == *executed.to_object());
+  }
+}